@@ -0,0 +1,186 @@
+// Front-end throughput on generated programs: Lexer::tokensize(),
+// Parser::parse() and printAST measured separately.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp optimizer/ast_utils.cpp bench/program_generator.cpp bench/frontend_bench.cpp -o frontend_bench
+// ./frontend_bench [--shape=NAME|all] [--size=BYTES] [--seed=N] [--runs=N] [--json]
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../optimizer/ast_utils.hpp"
+#include "../util/alloc_counter.hpp"
+#include "program_generator.hpp"
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+struct PhaseResult {
+    double seconds;      // best of all runs
+    size_t allocations;
+    size_t allocatedBytes;
+    size_t peakRssKb;
+    
+    PhaseResult() : seconds(1e300), allocations(0), allocatedBytes(0), peakRssKb(0) {}
+};
+
+struct ShapeResult {
+    std::string shape;
+    size_t bytes;
+    size_t tokens;
+    size_t nodes;
+    PhaseResult lex;
+    PhaseResult parse;
+    PhaseResult print;
+};
+
+class PhaseTimer {
+private:
+    PhaseResult& result;
+    AllocStats startAlloc;
+    std::chrono::steady_clock::time_point start;
+    
+public:
+    PhaseTimer(PhaseResult& r) : result(r) {
+        resetPeakRss();
+        startAlloc = allocStats();
+        start = std::chrono::steady_clock::now();
+    }
+    
+    ~PhaseTimer() {
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        AllocStats endAlloc = allocStats();
+        result.seconds = std::min(result.seconds, seconds);
+        result.allocations = endAlloc.allocations - startAlloc.allocations;
+        result.allocatedBytes = endAlloc.bytes - startAlloc.bytes;
+        result.peakRssKb = peakRssKb();
+    }
+};
+
+static ShapeResult runShape(const std::string& shape, const GeneratorOptions& base, int runs) {
+    GeneratorOptions options = base;
+    GeneratorOptions::preset(shape, options);
+    std::string source = ProgramGenerator(options).generate();
+    
+    ShapeResult result;
+    result.shape = shape;
+    result.bytes = source.size();
+    
+    for (int r = 0; r < runs; ++r) {
+        std::vector<Token> tokens;
+        {
+            PhaseTimer timer(result.lex);
+            Lexer lexer(source);
+            tokens = lexer.tokensize();
+        }
+        
+        std::vector<std::unique_ptr<ASTNode>> ast;
+        {
+            PhaseTimer timer(result.parse);
+            Parser parser(tokens);
+            ast = parser.parse();
+        }
+        
+        std::ostringstream dump;
+        {
+            PhaseTimer timer(result.print);
+            Parser printer(std::vector<Token>{});
+            printer.printAST(ast, dump);
+        }
+        
+        result.tokens = tokens.size();
+        result.nodes = countNodes(ast);
+    }
+    return result;
+}
+
+static void printPhaseJson(std::ostream& out, const char* name, const PhaseResult& phase,
+                           const ShapeResult& shape, bool last) {
+    out << "        \"" << name << "\": {"
+        << "\"seconds\": " << phase.seconds
+        << ", \"bytes_per_sec\": " << shape.bytes / phase.seconds
+        << ", \"tokens_per_sec\": " << shape.tokens / phase.seconds
+        << ", \"nodes_per_sec\": " << shape.nodes / phase.seconds
+        << ", \"allocations\": " << phase.allocations
+        << ", \"allocated_bytes\": " << phase.allocatedBytes
+        << ", \"peak_rss_kb\": " << phase.peakRssKb << "}"
+        << (last ? "\n" : ",\n");
+}
+
+static void printJson(const std::vector<ShapeResult>& results, const GeneratorOptions& options,
+                      int runs) {
+    std::ostream& out = std::cout;
+    out.precision(6);
+    out << "{\n  \"seed\": " << options.seed << ",\n  \"target_bytes\": " << options.targetBytes
+        << ",\n  \"runs\": " << runs << ",\n  \"shapes\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ShapeResult& r = results[i];
+        out << "    {\n      \"shape\": \"" << r.shape << "\", \"bytes\": " << r.bytes
+            << ", \"tokens\": " << r.tokens << ", \"nodes\": " << r.nodes
+            << ",\n      \"phases\": {\n";
+        printPhaseJson(out, "lex", r.lex, r, false);
+        printPhaseJson(out, "parse", r.parse, r, false);
+        printPhaseJson(out, "print", r.print, r, true);
+        out << "      }\n    }" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+static void printTable(const std::vector<ShapeResult>& results) {
+    std::cout << "shape              phase    MB/s     Mtok/s   Mnode/s  allocs     peak RSS KiB\n";
+    for (const auto& r : results) {
+        const char* names[] = {"lex", "parse", "print"};
+        const PhaseResult* phases[] = {&r.lex, &r.parse, &r.print};
+        for (int i = 0; i < 3; ++i) {
+            char line[160];
+            snprintf(line, sizeof(line), "%-18s %-8s %-8.1f %-8.2f %-8.2f %-10zu %zu\n",
+                     i == 0 ? r.shape.c_str() : "", names[i],
+                     r.bytes / phases[i]->seconds / 1e6,
+                     r.tokens / phases[i]->seconds / 1e6,
+                     r.nodes / phases[i]->seconds / 1e6,
+                     phases[i]->allocations, phases[i]->peakRssKb);
+            std::cout << line;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    std::string shape = "all";
+    int runs = 5;
+    bool json = false;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 8, "--shape=") == 0) shape = arg.substr(8);
+        else if (arg.compare(0, 7, "--size=") == 0) options.targetBytes = std::stoul(arg.substr(7));
+        else if (arg.compare(0, 7, "--seed=") == 0) options.seed = std::stoul(arg.substr(7));
+        else if (arg.compare(0, 7, "--runs=") == 0) runs = std::max(1, std::stoi(arg.substr(7)));
+        else if (arg == "--json") json = true;
+        else {
+            std::cerr << "Неизвестный аргумент: " << arg << std::endl;
+            return 1;
+        }
+    }
+    
+    std::vector<std::string> shapes;
+    if (shape == "all") {
+        shapes = GeneratorOptions::presetNames();
+    } else {
+        GeneratorOptions probe;
+        if (!GeneratorOptions::preset(shape, probe)) {
+            std::cerr << "Неизвестная форма программы: " << shape << std::endl;
+            return 1;
+        }
+        shapes.push_back(shape);
+    }
+    
+    std::vector<ShapeResult> results;
+    for (const auto& name : shapes) {
+        results.push_back(runShape(name, options, runs));
+    }
+    
+    if (json) {
+        printJson(results, options, runs);
+    } else {
+        printTable(results);
+    }
+    return 0;
+}
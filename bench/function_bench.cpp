@@ -0,0 +1,112 @@
+// Type checking and optimization of a program with many functions, with the
+// function bodies spread over 1, 2, 4 and 8 threads.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp semantic/*.cpp util/*.cpp optimizer/*.cpp interpreter/*.cpp bench/function_bench.cpp -o function_bench
+// ./function_bench [functions] [runs]
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../semantic/type_checker.hpp"
+#include "../optimizer/program_passes.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+typedef std::chrono::steady_clock Clock;
+
+static double millisSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// every function has locals, a loop with invariant and multiplied
+// expressions and calls the one before it; the top level calls them all
+static std::string makeProgram(int functions) {
+    std::ostringstream src;
+    for (int k = 0; k < functions; ++k) {
+        src << "int f" << k << "(int n, int m) {\n";
+        src << "    int debug = 0;\n";
+        src << "    int total = " << k << ";\n";
+        src << "    int i = 0;\n";
+        src << "    while (i < n) {\n";
+        src << "        int scale = m * 4 + " << k << ";\n";
+        src << "        total = total + i * 3 + scale;\n";
+        src << "        if (debug == 1) { print(\"f" << k << "\", total); }\n";
+        src << "        i = i + 1;\n";
+        src << "    }\n";
+        if (k > 0) {
+            src << "    total = total + f" << k - 1 << "(1, m);\n";
+        }
+        src << "    return total;\n";
+        src << "}\n";
+    }
+    src << "int sum = 0;\n";
+    for (int k = 0; k < functions; ++k) {
+        src << "sum = sum + f" << k << "(2, " << k << ");\n";
+    }
+    src << "print(sum);\n";
+    return src.str();
+}
+
+struct Timings {
+    double check;
+    double optimize;
+};
+
+static Timings measure(const std::vector<Token>& tokens, ThreadPool* pool) {
+    Parser parser(tokens);
+    auto program = parser.parse();
+    Timings t;
+
+    auto start = Clock::now();
+    TypeChecker checker;
+    std::vector<Diagnostic> diagnostics = checker.check(program, pool);
+    t.check = millisSince(start);
+    if (!diagnostics.empty()) {
+        printDiagnostics(diagnostics, std::cerr);
+        std::exit(1);
+    }
+
+    start = Clock::now();
+    propagateConstants(program, pool);
+    optimizeLoops(program, pool);
+    t.optimize = millisSince(start);
+    return t;
+}
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 4000;
+    int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::string source = makeProgram(functions);
+    Lexer lexer(source);
+    std::vector<Token> tokens = lexer.tokensize();
+    std::cout << functions << " функций, " << source.size() / 1024 << " КиБ, ядер: "
+              << std::thread::hardware_concurrency() << std::endl;
+
+    std::cout << std::left << std::setw(10) << "threads" << std::right
+              << std::setw(12) << "check ms" << std::setw(14) << "optimize ms"
+              << std::setw(10) << "speedup" << std::endl;
+    double baseline = 0;
+    for (size_t threads : {1, 2, 4, 8}) {
+        // 1 thread: no pool, the passes run inline
+        std::unique_ptr<ThreadPool> pool;
+        if (threads > 1) {
+            pool.reset(new ThreadPool(threads));
+        }
+        Timings best = {1e300, 1e300};
+        for (int run = 0; run < runs; ++run) {
+            Timings t = measure(tokens, pool.get());
+            best.check = std::min(best.check, t.check);
+            best.optimize = std::min(best.optimize, t.optimize);
+        }
+        double total = best.check + best.optimize;
+        if (threads == 1) {
+            baseline = total;
+        }
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << best.check
+                  << std::setw(14) << best.optimize
+                  << std::setw(9) << std::setprecision(2) << baseline / total << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Memory held by identifier names in the AST: interned 32-bit ids vs the
+// per-node std::string copies they replaced, on an identifier-heavy program.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp optimizer/ast_utils.cpp bench/intern_bench.cpp -o intern_bench
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../optimizer/ast_utils.hpp"
+#include <chrono>
+#include <random>
+#include <set>
+#include <sstream>
+
+// heap bytes of a std::string holding text (libstdc++ keeps up to 15 chars inline)
+static size_t stringBytes(const std::string& text) {
+    return sizeof(std::string) + (text.size() > 15 ? text.size() + 1 : 0);
+}
+
+struct NameStats {
+    size_t nodes;
+    size_t stringBytes;  // what std::string name fields would hold
+    std::set<SymbolId> distinct;
+    
+    NameStats() : nodes(0), stringBytes(0) {}
+    
+    void add(SymbolId name) {
+        nodes++;
+        stringBytes += ::stringBytes(symbolName(name));
+        distinct.insert(name);
+    }
+};
+
+static void countNames(StatementList& body, NameStats& stats) {
+    for (auto& stmt : body) {
+        if (auto decl = dynamic_cast<VarDeclarationNode*>(stmt.get())) {
+            stats.add(decl->name);
+        } else if (auto assign = dynamic_cast<AssignmentNode*>(stmt.get())) {
+            stats.add(assign->name);
+        }
+        forEachExprSlotDeep(stmt.get(), [&](std::unique_ptr<ASTNode>& slot) {
+            forEachSubExprSlot(slot, [&](std::unique_ptr<ASTNode>& node) {
+                if (auto ident = dynamic_cast<IdentifierNode*>(node.get())) {
+                    stats.add(ident->name);
+                } else if (auto call = dynamic_cast<FunctionCallNode*>(node.get())) {
+                    stats.add(call->name);
+                }
+            });
+        });
+        if (auto call = dynamic_cast<FunctionCallNode*>(stmt.get())) {
+            stats.add(call->name);
+        }
+    }
+}
+
+int main() {
+    const int distinctNames = 500;
+    const int statements = 100000;
+    
+    std::vector<std::string> names;
+    for (int i = 0; i < distinctNames; ++i) {
+        names.push_back("customer_account_balance_" + std::to_string(i));
+    }
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, distinctNames - 1);
+    
+    std::ostringstream src;
+    for (const auto& name : names) {
+        src << "int " << name << " = 0;\n";
+    }
+    for (int i = 0; i < statements; ++i) {
+        src << names[pick(rng)] << " = " << names[pick(rng)] << " + "
+            << names[pick(rng)] << " * " << names[pick(rng)] << ";\n";
+        if (i % 10 == 0) {
+            src << "print(" << names[pick(rng)] << ");\n";
+        }
+    }
+    
+    Lexer lexer(src.str());
+    Parser parser(lexer.tokensize());
+    auto ast = parser.parse();
+    
+    NameStats stats;
+    countNames(ast, stats);
+    
+    size_t idBytes = stats.nodes * sizeof(SymbolId);
+    // interner: map node (key + id + hash + next pointer) and the id -> name slot
+    size_t internerBytes = 0;
+    for (SymbolId id : stats.distinct) {
+        internerBytes += stringBytes(symbolName(id)) + sizeof(SymbolId) +
+                         2 * sizeof(void*) + sizeof(size_t) + sizeof(void*);
+    }
+    
+    // equality on names: string compare vs integer compare
+    std::vector<std::string> asStrings;
+    std::vector<SymbolId> asIds;
+    for (int i = 0; i < 1 << 16; ++i) {
+        int index = pick(rng);
+        asStrings.push_back(names[index]);
+        asIds.push_back(internSymbol(names[index]));
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t equalStrings = 0;
+    for (size_t i = 1; i < asStrings.size(); ++i) {
+        for (int k = 0; k < 64; ++k) {
+            equalStrings += asStrings[i] == asStrings[(i * 31 + k) & 0xFFFF];
+        }
+    }
+    double stringMillis = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    size_t equalIds = 0;
+    for (size_t i = 1; i < asIds.size(); ++i) {
+        for (int k = 0; k < 64; ++k) {
+            equalIds += asIds[i] == asIds[(i * 31 + k) & 0xFFFF];
+        }
+    }
+    double idMillis = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "name references:       " << stats.nodes << " (" << stats.distinct.size()
+              << " distinct)\n";
+    std::cout << "as std::string fields: " << stats.stringBytes / 1024 << " KiB\n";
+    std::cout << "as interned ids:       " << (idBytes + internerBytes) / 1024 << " KiB ("
+              << idBytes / 1024 << " KiB ids + " << internerBytes / 1024 << " KiB interner)\n";
+    std::cout << "saved:                 " << (stats.stringBytes - idBytes - internerBytes) / 1024
+              << " KiB\n";
+    std::cout << "4M name comparisons:   " << stringMillis << " ms as strings, "
+              << idMillis << " ms as ids (" << equalStrings << "/" << equalIds << " equal)\n";
+    return equalStrings == equalIds ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// Execution time of a loop-heavy program before/after LoopOptimizer.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp optimizer/*.cpp interpreter/*.cpp bench/loop_bench.cpp -o loop_bench
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../optimizer/loop_optimizer.hpp"
+#include "../interpreter/interpreter.hpp"
+#include <chrono>
+#include <sstream>
+
+static const char* program = R"(
+    int n = 300000;
+    int a = 3;
+    int b = 7;
+    float scale = 0.5;
+    int i = 0;
+    int sum = 0;
+    float acc = 0.0;
+    while (i < n) {
+        sum = sum + i * 8 + (a * b + a);
+        acc = acc + scale * (a + b);
+        if (sum > 1000000) {
+            sum = sum - (a * b + a) * 1000;
+        }
+        i = i + 1;
+    }
+    print(sum);
+    print(acc);
+)";
+
+static std::vector<std::unique_ptr<ASTNode>> parseProgram() {
+    Lexer lexer(program);
+    Parser parser(lexer.tokensize());
+    return parser.parse();
+}
+
+static double runMillis(const std::vector<std::unique_ptr<ASTNode>>& ast, std::string& output) {
+    std::ostringstream out;
+    Interpreter interpreter(out);
+    auto start = std::chrono::steady_clock::now();
+    interpreter.run(ast);
+    auto end = std::chrono::steady_clock::now();
+    output = out.str();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    auto baseline = parseProgram();
+    auto optimized = parseProgram();
+    
+    LoopOptimizer optimizer;
+    LoopOptStats stats = optimizer.run(optimized);
+    
+    const int runs = 5;
+    double best[2] = {1e300, 1e300};
+    std::string output[2];
+    for (int r = 0; r < runs; ++r) {
+        best[0] = std::min(best[0], runMillis(baseline, output[0]));
+        best[1] = std::min(best[1], runMillis(optimized, output[1]));
+    }
+    
+    std::cout << "loops: " << stats.loops
+              << ", induction variables: " << stats.inductionVariables
+              << ", hoisted: " << stats.hoisted
+              << ", strength-reduced: " << stats.strengthReduced << "\n";
+    std::cout << "before: " << best[0] << " ms\n";
+    std::cout << "after:  " << best[1] << " ms\n";
+    std::cout << "speedup: " << best[0] / best[1] << "x\n";
+    
+    if (output[0] != output[1]) {
+        std::cerr << "output mismatch:\n" << output[0] << "---\n" << output[1];
+        return 1;
+    }
+    return 0;
+}
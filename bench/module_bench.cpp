@@ -0,0 +1,195 @@
+// Front-end time of a program on a deep import graph: all modules pasted into
+// one source, imported with no interface files (cold), and imported again
+// with the interface files from the cold run (warm), on 1 and 4 threads.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp semantic/*.cpp util/*.cpp optimizer/ast_utils.cpp module/*.cpp bench/module_bench.cpp -o module_bench
+// ./module_bench [depth] [width] [functions per module] [runs]
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../semantic/type_checker.hpp"
+#include "../module/module_loader.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock Clock;
+
+static double millisSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Graph {
+    int depth;      // levels of modules, level 0 imported by the program
+    int width;      // modules per level
+    int functions;  // per module
+};
+
+static std::string moduleName(int level, int index) {
+    return "m" + std::to_string(level) + "_" + std::to_string(index);
+}
+
+// module (l, w) imports (l + 1, w) and (l + 1, w + 1): every level is a row
+// of diamonds, so each module is imported twice
+static std::string moduleImports(const Graph& graph, int level, int index) {
+    std::ostringstream src;
+    if (level + 1 < graph.depth) {
+        src << "import \"" << moduleName(level + 1, index) << ".txt\";\n";
+        src << "import \"" << moduleName(level + 1, (index + 1) % graph.width) << ".txt\";\n";
+    }
+    return src.str();
+}
+
+static std::string moduleFunctions(const Graph& graph, int level, int index) {
+    std::ostringstream src;
+    std::string prefix = moduleName(level, index);
+    for (int k = 0; k < graph.functions; ++k) {
+        src << "int " << prefix << "_f" << k << "(int n) {\n";
+        src << "    int total = " << k << ";\n";
+        src << "    int i = 0;\n";
+        src << "    while (i < n) {\n";
+        src << "        total = total + i * " << k + 1 << " - n / 2;\n";
+        src << "        if (total > 1000) { total = total - 1000; }\n";
+        src << "        i = i + 1;\n";
+        src << "    }\n";
+        if (level + 1 < graph.depth) {
+            src << "    total = total + " << moduleName(level + 1, index) << "_f" << k << "(n - 1);\n";
+        }
+        src << "    return total;\n";
+        src << "}\n";
+    }
+    return src.str();
+}
+
+static std::string programCalls(const Graph& graph) {
+    std::ostringstream src;
+    src << "int sum = 0;\n";
+    for (int w = 0; w < graph.width; ++w) {
+        src << "sum = sum + " << moduleName(0, w) << "_f0(3);\n";
+    }
+    src << "print(sum);\n";
+    return src.str();
+}
+
+static void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+}
+
+// lex, parse and check the whole program from one source
+static double pasted(const std::string& source) {
+    auto start = Clock::now();
+    Lexer lexer(source);
+    Parser parser(lexer.tokensize());
+    auto program = parser.parse();
+    TypeChecker checker;
+    if (!checker.check(program).empty()) {
+        std::cerr << "ошибки типов в склеенной программе" << std::endl;
+        std::exit(1);
+    }
+    return millisSince(start);
+}
+
+// the same through imports; the program's own code is checked too
+static double imported(const std::string& source, const std::string& directory,
+                       ThreadPool* pool, size_t& cached) {
+    auto start = Clock::now();
+    Lexer lexer(source);
+    Parser parser(lexer.tokensize());
+    auto program = parser.parse();
+    ModuleLoader loader(pool);
+    if (!loader.load(program, directory)) {
+        std::exit(1);
+    }
+    StatementList functions = loader.takeFunctions();
+    TypeChecker checker;
+    for (const auto& function : functions) {
+        checker.importFunction(static_cast<const FunctionDefNode*>(function.get()));
+    }
+    if (!checker.check(program).empty()) {
+        std::cerr << "ошибки типов в программе" << std::endl;
+        std::exit(1);
+    }
+    cached = loader.cachedCount();
+    return millisSince(start);
+}
+
+int main(int argc, char* argv[]) {
+    Graph graph;
+    graph.depth = argc > 1 ? std::atoi(argv[1]) : 30;
+    graph.width = argc > 2 ? std::atoi(argv[2]) : 4;
+    graph.functions = argc > 3 ? std::atoi(argv[3]) : 20;
+    int runs = argc > 4 ? std::atoi(argv[4]) : 5;
+
+    char directoryTemplate[] = "/tmp/module_bench.XXXXXX";
+    if (!mkdtemp(directoryTemplate)) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    std::string directory = directoryTemplate;
+
+    std::vector<std::string> files;
+    std::string all;
+    for (int level = 0; level < graph.depth; ++level) {
+        for (int index = 0; index < graph.width; ++index) {
+            std::string functions = moduleFunctions(graph, level, index);
+            std::string path = directory + "/" + moduleName(level, index) + ".txt";
+            writeFile(path, moduleImports(graph, level, index) + functions);
+            files.push_back(path);
+            all += functions;
+        }
+    }
+    std::string program;
+    for (int w = 0; w < graph.width; ++w) {
+        program += "import \"" + moduleName(0, w) + ".txt\";\n";
+    }
+    program += programCalls(graph);
+    all += programCalls(graph);
+
+    std::cout << graph.depth << " уровней x " << graph.width << " модулей, "
+              << graph.functions << " функций в модуле, " << all.size() / 1024
+              << " КиБ исходного текста, ядер: " << std::thread::hardware_concurrency() << std::endl;
+
+    double pastedMs = 1e300;
+    for (int run = 0; run < runs; ++run) {
+        pastedMs = std::min(pastedMs, pasted(all));
+    }
+    std::cout << std::left << std::setw(22) << "variant" << std::right << std::setw(10) << "ms"
+              << std::setw(10) << "cached" << std::setw(10) << "speedup" << std::endl;
+    std::cout << std::left << std::setw(22) << "pasted" << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << pastedMs << std::setw(10) << "-"
+              << std::setw(9) << std::setprecision(2) << 1.0 << "x" << std::endl;
+
+    for (size_t threads : {1, 4}) {
+        std::unique_ptr<ThreadPool> pool;
+        if (threads > 1) {
+            pool.reset(new ThreadPool(threads));
+        }
+        for (int warm = 0; warm < 2; ++warm) {
+            double best = 1e300;
+            size_t cached = 0;
+            for (int run = 0; run < runs; ++run) {
+                if (!warm) {
+                    for (const std::string& file : files) {
+                        std::remove(interfacePath(file).c_str());
+                    }
+                }
+                best = std::min(best, imported(program, directory, pool.get(), cached));
+            }
+            std::string name = std::string(warm ? "import warm" : "import cold") +
+                               ", " + std::to_string(threads) + " thr";
+            std::cout << std::left << std::setw(22) << name << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(10) << best << std::setw(10) << cached
+                      << std::setw(9) << std::setprecision(2) << pastedMs / best << "x" << std::endl;
+        }
+    }
+
+    for (const std::string& file : files) {
+        std::remove(interfacePath(file).c_str());
+        std::remove(file.c_str());
+    }
+    rmdir(directory.c_str());
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Interpreter run time without a profiler, sampling and counting.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp interpreter/*.cpp bench/profiler_bench.cpp -o profiler_bench
+// ./profiler_bench [iterations]
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../interpreter/interpreter.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+struct Workload {
+    const char* name;
+    std::string source;
+};
+
+static double runMs(const std::vector<std::unique_ptr<ASTNode>>& program, Profiler* profiler) {
+    std::ostringstream sink;
+    auto t0 = std::chrono::steady_clock::now();
+    Interpreter interpreter(sink);
+    interpreter.setProfiler(profiler);
+    interpreter.run(program);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 300000;
+    std::string count = std::to_string(n);
+    std::vector<Workload> workloads = {
+        {"flat", "int sum = 0;\nint i = 0;\nwhile (i < " + count + ") {\n"
+                 "    sum = sum + i * 2 - i / 3;\n    i = i + 1;\n}\nprint(sum);\n"},
+        {"nested", "int total = 0;\nint i = 0;\nwhile (i < " + std::to_string(n / 10) + ") {\n"
+                   "    int j = 0;\n    while (j < 10) {\n        total = total + i * j;\n"
+                   "        j = j + 1;\n    }\n    if (i / 2 * 2 == i) {\n        total = total - 1;\n"
+                   "    }\n    i = i + 1;\n}\nprint(total);\n"},
+        {"strings", "string s = \"\";\nint i = 0;\nwhile (i < " + std::to_string(n / 10) + ") {\n"
+                    "    s = s + \"x\";\n    if (s == \"never\") { print(s); }\n    i = i + 1;\n}\n"},
+    };
+
+    std::cout << std::left << std::setw(10) << "program" << std::right
+              << std::setw(10) << "none ms" << std::setw(10) << "sample" << std::setw(9) << "%"
+              << std::setw(10) << "count" << std::setw(9) << "%" << std::endl;
+    for (const Workload& workload : workloads) {
+        Lexer lexer(workload.source);
+        Parser parser(lexer.tokensize());
+        auto program = parser.parse();
+
+        // interleaved, best of 5 each, so drift hits all three alike
+        double none = 1e300, sampled = 1e300, counted = 1e300;
+        for (int run = 0; run < 5; ++run) {
+            none = std::min(none, runMs(program, nullptr));
+            Profiler sampler(ProfileMode::SAMPLE);
+            sampled = std::min(sampled, runMs(program, &sampler));
+            Profiler counter(ProfileMode::COUNT);
+            counted = std::min(counted, runMs(program, &counter));
+        }
+        std::cout << std::left << std::setw(10) << workload.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << none
+                  << std::setw(10) << sampled << std::setw(8) << 100.0 * (sampled / none - 1) << "%"
+                  << std::setw(10) << counted << std::setw(8) << 100.0 * (counted / none - 1) << "%"
+                  << std::endl;
+    }
+    return 0;
+}
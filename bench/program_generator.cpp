@@ -0,0 +1,239 @@
+#include "program_generator.hpp"
+
+GeneratorOptions::GeneratorOptions()
+    : seed(1), targetBytes(1 << 20), maxNesting(4), expressionLength(4),
+      declarationWeight(3), assignmentWeight(5), ifWeight(2), whileWeight(1),
+      printWeight(1), commentWeight(1), stringLength(24) {}
+
+std::vector<std::string> GeneratorOptions::presetNames() {
+    return {"balanced", "deep-nesting", "long-expressions", "declarations", "comments-strings"};
+}
+
+bool GeneratorOptions::preset(const std::string& shape, GeneratorOptions& options) {
+    GeneratorOptions base;
+    base.seed = options.seed;
+    base.targetBytes = options.targetBytes;
+    
+    if (shape == "balanced") {
+        // defaults
+    } else if (shape == "deep-nesting") {
+        base.maxNesting = 40;
+        base.ifWeight = 6;
+        base.whileWeight = 3;
+        base.declarationWeight = 1;
+        base.assignmentWeight = 2;
+        base.commentWeight = 0;
+    } else if (shape == "long-expressions") {
+        base.expressionLength = 64;
+        base.ifWeight = 1;
+        base.whileWeight = 0;
+        base.printWeight = 0;
+        base.commentWeight = 0;
+    } else if (shape == "declarations") {
+        base.declarationWeight = 20;
+        base.assignmentWeight = 1;
+        base.ifWeight = 0;
+        base.whileWeight = 0;
+        base.printWeight = 0;
+        base.commentWeight = 0;
+        base.expressionLength = 1;
+    } else if (shape == "comments-strings") {
+        base.commentWeight = 10;
+        base.printWeight = 10;
+        base.stringLength = 120;
+        base.assignmentWeight = 1;
+        base.declarationWeight = 1;
+    } else {
+        return false;
+    }
+    options = base;
+    return true;
+}
+
+ProgramGenerator::ProgramGenerator(const GeneratorOptions& opts)
+    : options(opts), rng(opts.seed), nameCounter(0) {}
+
+int ProgramGenerator::pick(int low, int high) {
+    return std::uniform_int_distribution<int>(low, high)(rng);
+}
+
+std::string ProgramGenerator::text(size_t length) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz   ,.!?0123456789";
+    std::string result;
+    for (size_t i = 0; i < length; ++i) {
+        result += alphabet[pick(0, sizeof(alphabet) - 2)];
+    }
+    return result;
+}
+
+std::string ProgramGenerator::anyVariable() {
+    // inner scopes are more likely, like real code
+    size_t scope = scopes.size() - 1;
+    while (scope > 0 && (scopes[scope].empty() || pick(0, 3) == 0)) {
+        scope--;
+    }
+    const auto& names = scopes[scope];
+    return names[pick(0, static_cast<int>(names.size()) - 1)];
+}
+
+std::string ProgramGenerator::newVariable() {
+    static const char* stems[] = {"count", "total", "index", "value", "offset", "size", "tmp", "acc"};
+    int id = nameCounter++;
+    return std::string(stems[id % 8]) + "_" + std::to_string(id);
+}
+
+void ProgramGenerator::indent(int depth) {
+    out.append(depth * 4, ' ');
+}
+
+std::string ProgramGenerator::generate() {
+    out.clear();
+    scopes.assign(1, std::vector<std::string>());
+    
+    // a few globals so that expressions always have operands
+    for (int i = 0; i < 4; ++i) {
+        declaration(0);
+    }
+    while (out.size() < options.targetBytes) {
+        statement(0);
+    }
+    return out;
+}
+
+void ProgramGenerator::statement(int depth) {
+    // past the size budget only flat statements are added, so the
+    // recursion always bottoms out
+    bool canNest = depth < options.maxNesting && out.size() < options.targetBytes;
+    int weights[] = {
+        options.declarationWeight,
+        options.assignmentWeight,
+        canNest ? options.ifWeight : 0,
+        canNest ? options.whileWeight : 0,
+        options.printWeight,
+        options.commentWeight,
+    };
+    int total = 0;
+    for (int w : weights) total += w;
+    
+    int roll = pick(0, total - 1);
+    int kind = 0;
+    while (roll >= weights[kind]) {
+        roll -= weights[kind++];
+    }
+    
+    switch (kind) {
+        case 0: declaration(depth); break;
+        case 1: assignment(depth); break;
+        case 2: ifStatement(depth); break;
+        case 3: whileStatement(depth); break;
+        case 4: printCall(depth); break;
+        default: comment(depth); break;
+    }
+}
+
+void ProgramGenerator::declaration(int depth) {
+    std::string name = newVariable();
+    indent(depth);
+    switch (pick(0, 5)) {
+        case 0:
+            out += "float " + newVariable() + " = " + std::to_string(pick(0, 999)) + ".5;\n";
+            indent(depth);
+            break;
+        case 1:
+            out += "string " + newVariable() + " = \"" + text(options.stringLength) + "\";\n";
+            indent(depth);
+            break;
+        case 2:
+            out += "bool " + newVariable() + " = " + (pick(0, 1) ? "true" : "false") + ";\n";
+            indent(depth);
+            break;
+        default:
+            break;
+    }
+    out += "int " + name + " = " +
+           (scopes.back().empty() && scopes.size() == 1 ? std::to_string(pick(0, 100))
+                                                         : expression(options.expressionLength)) +
+           ";\n";
+    scopes.back().push_back(name);
+}
+
+void ProgramGenerator::assignment(int depth) {
+    indent(depth);
+    out += anyVariable() + " = " + expression(options.expressionLength) + ";\n";
+}
+
+void ProgramGenerator::ifStatement(int depth) {
+    indent(depth);
+    static const char* comparisons[] = {"<", ">", "==", "!=", "<=", ">="};
+    out += "if (" + expression(2) + " " + comparisons[pick(0, 5)] + " " + expression(2) + ") ";
+    block(depth);
+    if (pick(0, 1)) {
+        indent(depth);
+        out += "else ";
+        block(depth);
+    }
+}
+
+void ProgramGenerator::whileStatement(int depth) {
+    // bounded loop: fresh counter, so generated programs terminate when run
+    std::string counter = newVariable();
+    indent(depth);
+    out += "int " + counter + " = 0;\n";
+    indent(depth);
+    out += "while (" + counter + " < " + std::to_string(pick(1, 8)) + ") {\n";
+    scopes.push_back(std::vector<std::string>());
+    int count = pick(1, 4);
+    for (int i = 0; i < count; ++i) {
+        statement(depth + 1);
+    }
+    scopes.pop_back();
+    indent(depth + 1);
+    out += counter + " = " + counter + " + 1;\n";
+    indent(depth);
+    out += "}\n";
+    scopes.back().push_back(counter);
+}
+
+void ProgramGenerator::printCall(int depth) {
+    indent(depth);
+    out += "print(\"" + text(options.stringLength) + "\\n\", " + anyVariable() + ");\n";
+}
+
+void ProgramGenerator::comment(int depth) {
+    indent(depth);
+    out += "// " + text(options.stringLength) + "\n";
+}
+
+void ProgramGenerator::block(int depth) {
+    out += "{\n";
+    scopes.push_back(std::vector<std::string>());
+    int count = pick(1, 4);
+    for (int i = 0; i < count; ++i) {
+        statement(depth + 1);
+    }
+    scopes.pop_back();
+    indent(depth);
+    out += "}\n";
+}
+
+std::string ProgramGenerator::expression(int length) {
+    static const char* operators[] = {"+", "-", "*"};
+    std::string result;
+    int open = 0;
+    for (int i = 0; i < length; ++i) {
+        if (i > 0) {
+            result += std::string(" ") + operators[pick(0, 2)] + " ";
+        }
+        if (i + 1 < length && pick(0, 5) == 0) {
+            result += "(";
+            open++;
+        }
+        result += pick(0, 2) ? anyVariable() : std::to_string(pick(0, 1000));
+        if (open > 0 && pick(0, 2) == 0) {
+            result += ")";
+            open--;
+        }
+    }
+    result.append(open, ')');
+    return result;
+}
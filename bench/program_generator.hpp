@@ -0,0 +1,62 @@
+#ifndef PROGRAM_GENERATOR_HPP
+#define PROGRAM_GENERATOR_HPP
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Shape of a synthetic program; the same seed always gives the same source.
+struct GeneratorOptions {
+    uint32_t seed;
+    size_t targetBytes;     // generation stops once the source is this long
+    int maxNesting;         // if/while depth
+    int expressionLength;   // operands per expression chain
+    // relative weights of the statement kinds
+    int declarationWeight;
+    int assignmentWeight;
+    int ifWeight;
+    int whileWeight;
+    int printWeight;
+    int commentWeight;
+    size_t stringLength;    // characters in string literals and comments
+    
+    GeneratorOptions();
+    
+    // "balanced", "deep-nesting", "long-expressions", "declarations", "comments-strings"
+    static bool preset(const std::string& shape, GeneratorOptions& options);
+    static std::vector<std::string> presetNames();
+};
+
+// Generates programs that lex, parse and type-check cleanly: every variable is
+// declared before use, arithmetic stays in int, loops have a bounded counter.
+class ProgramGenerator {
+private:
+    GeneratorOptions options;
+    std::mt19937 rng;
+    std::string out;
+    std::vector<std::vector<std::string>> scopes;  // visible int variables
+    int nameCounter;
+    
+    int pick(int low, int high);
+    std::string text(size_t length);
+    std::string anyVariable();
+    std::string newVariable();
+    void indent(int depth);
+    
+    void statement(int depth);
+    void declaration(int depth);
+    void assignment(int depth);
+    void ifStatement(int depth);
+    void whileStatement(int depth);
+    void printCall(int depth);
+    void comment(int depth);
+    void block(int depth);
+    std::string expression(int length);
+    
+public:
+    ProgramGenerator(const GeneratorOptions& opts);
+    std::string generate();
+};
+
+#endif
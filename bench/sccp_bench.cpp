@@ -0,0 +1,101 @@
+// Effect of ConstantPropagator on downstream compile time (loop optimizer +
+// AST dump) and on interpreted run time.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp optimizer/*.cpp interpreter/*.cpp bench/sccp_bench.cpp -o sccp_bench
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../optimizer/constant_propagation.hpp"
+#include "../optimizer/loop_optimizer.hpp"
+#include "../interpreter/interpreter.hpp"
+#include <chrono>
+#include <sstream>
+
+typedef std::chrono::steady_clock Clock;
+
+static double millisSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// constant debug flags checked far from their declaration, plus dead temporaries
+static std::string makeProgram(int blocks, int iterations) {
+    std::ostringstream src;
+    src << "int debug = 0;\nint verbose = 0;\nint total = 0;\n";
+    for (int k = 0; k < blocks; ++k) {
+        src << "int tmp" << k << " = " << k << " * 2;\n";
+        src << "if (debug == 1) { print(\"block\", " << k << "); total = total + "
+            << k << " * 3; }\n";
+        src << "total = total + " << k << ";\n";
+    }
+    src << "int i = 0;\n";
+    src << "while (i < " << iterations << ") {\n";
+    src << "    if (verbose == 1) { print(\"iteration\", i); }\n";
+    src << "    int scratch = i * 3 + debug;\n";
+    src << "    total = total + i;\n";
+    src << "    i = i + 1;\n";
+    src << "}\n";
+    src << "print(total);\n";
+    return src.str();
+}
+
+struct Timings {
+    double compile;
+    double run;
+    std::string output;
+};
+
+static Timings measure(std::vector<std::unique_ptr<ASTNode>>& ast) {
+    Timings timings;
+    
+    auto start = Clock::now();
+    LoopOptimizer loopOptimizer;
+    loopOptimizer.run(ast);
+    std::ostringstream dump;
+    for (const auto& stmt : ast) {
+        dump << stmt->toString() << "\n";
+    }
+    timings.compile = millisSince(start);
+    
+    std::ostringstream out;
+    Interpreter interpreter(out);
+    start = Clock::now();
+    interpreter.run(ast);
+    timings.run = millisSince(start);
+    timings.output = out.str();
+    return timings;
+}
+
+int main() {
+    std::string source = makeProgram(2000, 100000);
+    Lexer lexer(source);
+    std::vector<Token> tokens = lexer.tokensize();
+    
+    Parser baselineParser(tokens);
+    auto baseline = baselineParser.parse();
+    Parser optimizedParser(tokens);
+    auto optimized = optimizedParser.parse();
+    
+    auto start = Clock::now();
+    ConstantPropagator propagator;
+    ConstPropStats stats = propagator.run(optimized);
+    double sccpTime = millisSince(start);
+    
+    Timings before = measure(baseline);
+    Timings after = measure(optimized);
+    
+    std::cout << "statements: " << stats.statementsBefore << " -> " << stats.statementsAfter
+              << " (eliminated " << stats.statementsBefore - stats.statementsAfter << ")\n";
+    std::cout << "propagated: " << stats.propagated
+              << ", folded: " << stats.folded
+              << ", branches resolved: " << stats.branchesResolved
+              << ", unreachable: " << stats.unreachableRemoved
+              << ", dead stores: " << stats.deadStoresRemoved
+              << ", declarations: " << stats.declarationsRemoved << "\n";
+    std::cout << "sccp pass:          " << sccpTime << " ms\n";
+    std::cout << "downstream compile: " << before.compile << " ms -> " << after.compile << " ms\n";
+    std::cout << "run:                " << before.run << " ms -> " << after.run << " ms\n";
+    
+    if (before.output != after.output) {
+        std::cerr << "output mismatch:\n" << before.output << "---\n" << after.output;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+// Compile latency: a fresh compiler process per file against requests to a
+// warm compile server (cache miss and hit), plus throughput with concurrent clients.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp semantic/*.cpp util/*.cpp optimizer/*.cpp module/*.cpp interpreter/*.cpp instrument/*.cpp driver/*.cpp server/*.cpp bench/program_generator.cpp bench/server_bench.cpp -o server_bench
+// ./server_bench ./compiler [--files=N] [--size=BYTES] [--clients=N]
+#include "../server/compile_client.hpp"
+#include "../server/compile_server.hpp"
+#include "../util/alloc_counter.hpp"
+#include "program_generator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock Clock;
+
+static double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void report(const std::string& name, std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double s : samples) sum += s;
+    std::cout << std::fixed << std::setprecision(3)
+              << "p50 " << std::setw(8) << samples[samples.size() / 2] << " ms"
+              << "  p95 " << std::setw(8) << samples[samples.size() * 95 / 100] << " ms"
+              << "  mean " << std::setw(8) << sum / samples.size() << " ms  " << name << std::endl;
+}
+
+// fork/exec with stdout and stderr discarded, like a build system would
+static void runProcess(const std::vector<std::string>& args) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, 1);
+        dup2(null, 2);
+        std::vector<char*> argv;
+        for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+}
+
+static std::vector<double> timeRequests(const std::string& socket, const std::vector<CompileRequest>& requests) {
+    std::vector<double> samples;
+    for (const CompileRequest& request : requests) {
+        Clock::time_point start = Clock::now();
+        int fd = connectToServer(socket);
+        CompileResponse response;
+        if (fd < 0 || !sendCompileRequest(fd, request, response)) {
+            std::cerr << "запрос к серверу не выполнен" << std::endl;
+            std::exit(1);
+        }
+        close(fd);
+        samples.push_back(millisecondsSince(start));
+    }
+    return samples;
+}
+
+static std::string generate(uint32_t seed, size_t size) {
+    GeneratorOptions options;
+    GeneratorOptions::preset("balanced", options);
+    options.seed = seed;
+    options.targetBytes = size;
+    return ProgramGenerator(options).generate();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Использование: server_bench ./compiler [--files=N] [--size=BYTES] [--clients=N]" << std::endl;
+        return 1;
+    }
+    std::string compiler = argv[1];
+    size_t files = 50;
+    size_t size = 4000;
+    size_t clients = std::max(2u, std::thread::hardware_concurrency());
+    for (int i = 2; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--files=", 8) == 0) files = std::strtoul(argv[i] + 8, nullptr, 10);
+        else if (std::strncmp(argv[i], "--size=", 7) == 0) size = std::strtoul(argv[i] + 7, nullptr, 10);
+        else if (std::strncmp(argv[i], "--clients=", 10) == 0) clients = std::strtoul(argv[i] + 10, nullptr, 10);
+    }
+    setAllocCounting(false);
+    
+    char dirTemplate[] = "/tmp/server_bench_XXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+    std::vector<std::string> paths;
+    std::vector<CompileRequest> requests;
+    for (size_t i = 0; i < files; ++i) {
+        std::string path = dir + "/prog" + std::to_string(i) + ".txt";
+        std::ofstream(path) << generate(static_cast<uint32_t>(i + 1), size);
+        paths.push_back(path);
+        requests.push_back(CompileRequest(RequestKind::PATH, path));
+    }
+    std::cout << files << " файлов по ~" << size << " байт" << std::endl;
+    
+    // before the server thread exists, so fork() copies a single-threaded process
+    std::vector<double> cold;
+    for (const std::string& path : paths) {
+        Clock::time_point start = Clock::now();
+        runProcess({compiler, path});
+        cold.push_back(millisecondsSince(start));
+    }
+    report("процесс на файл", cold);
+    
+    std::string socket = dir + "/server.sock";
+    CompileServer server(socket);
+    std::string error;
+    if (!server.listen(error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::thread serverThread([&server]() { server.run(); });
+    
+    report("сервер, промах кэша", timeRequests(socket, requests));
+    report("сервер, попадание в кэш", timeRequests(socket, requests));
+    
+    std::vector<double> thin;
+    for (const std::string& path : paths) {
+        Clock::time_point start = Clock::now();
+        runProcess({compiler, "--client=" + socket, path});
+        thin.push_back(millisecondsSince(start));
+    }
+    report("--client, попадание в кэш", thin);
+    
+    // distinct sources per client so every request compiles
+    for (size_t n : {size_t(1), clients}) {
+        size_t perClient = std::max<size_t>(files / n, 4);
+        std::vector<std::vector<CompileRequest>> work(n);
+        for (size_t c = 0; c < n; ++c) {
+            for (size_t i = 0; i < perClient; ++i) {
+                uint32_t seed = static_cast<uint32_t>(100000 * n + 1000 * c + i);
+                work[c].push_back(CompileRequest(RequestKind::SOURCE, generate(seed, size)));
+            }
+        }
+        Clock::time_point start = Clock::now();
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < n; ++c) {
+            threads.push_back(std::thread([&socket, &work, c]() { timeRequests(socket, work[c]); }));
+        }
+        for (std::thread& t : threads) t.join();
+        double seconds = millisecondsSince(start) / 1000;
+        std::cout << "клиентов " << std::setw(3) << n << ": " << std::setprecision(1)
+                  << n * perClient / seconds << " компиляций/с" << std::endl;
+    }
+    
+    std::cout << "запросов " << server.requestCount() << ", из кэша " << server.cacheHitCount() << std::endl;
+    server.stop();
+    serverThread.join();
+    
+    for (const std::string& path : paths) unlink(path.c_str());
+    rmdir(dir.c_str());
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Symbol table lookups/sec with 100k variables: flat table keyed by interned
+// ids vs a string-keyed std::unordered_map, plus a full TypeChecker run.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp semantic/*.cpp util/*.cpp bench/symtab_bench.cpp -o symtab_bench
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../semantic/type_checker.hpp"
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main() {
+    const int variables = 100000;
+    const int lookups = 10000000;
+    
+    std::vector<std::string> names;
+    for (int i = 0; i < variables; ++i) {
+        names.push_back("var_" + std::to_string(i));
+    }
+    
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, variables - 1);
+    std::vector<int> order(1 << 20);
+    for (auto& index : order) {
+        index = pick(rng);
+    }
+    
+    // flat table keyed by interned ids
+    StringInterner interner;
+    std::vector<SymbolId> ids;
+    for (const auto& name : names) {
+        ids.push_back(interner.intern(name));
+    }
+    SymbolTable table;
+    table.enterScope();
+    for (SymbolId id : ids) {
+        table.declare(id, StaticType::INT);
+    }
+    // a few shadowing scopes on top, like nested blocks
+    for (int depth = 0; depth < 8; ++depth) {
+        table.enterScope();
+        for (int i = depth; i < variables; i += 97) {
+            table.declare(ids[i], StaticType::FLOAT);
+        }
+    }
+    
+    auto start = Clock::now();
+    long found = 0;
+    for (int i = 0; i < lookups; ++i) {
+        const Symbol* symbol = table.lookup(ids[order[i & (order.size() - 1)]]);
+        found += symbol->depth;
+    }
+    double flatSeconds = secondsSince(start);
+    
+    // string-keyed baseline
+    std::unordered_map<std::string, StaticType> map;
+    for (const auto& name : names) {
+        map[name] = StaticType::INT;
+    }
+    start = Clock::now();
+    long mapFound = 0;
+    for (int i = 0; i < lookups; ++i) {
+        mapFound += static_cast<int>(map.find(names[order[i & (order.size() - 1)]])->second);
+    }
+    double mapSeconds = secondsSince(start);
+    
+    // whole pass over a program with 100k declarations and uses
+    std::ostringstream src;
+    for (int i = 0; i < variables; ++i) {
+        src << "int " << names[i] << " = " << i << ";\n";
+    }
+    for (int i = 0; i < variables; ++i) {
+        src << names[i] << " = " << names[order[i]] << " + " << names[i] << ";\n";
+    }
+    Lexer lexer(src.str());
+    Parser parser(lexer.tokensize());
+    auto ast = parser.parse();
+    start = Clock::now();
+    TypeChecker checker;
+    size_t errors = checker.check(ast).size();
+    double checkSeconds = secondsSince(start);
+    
+    std::cout << "variables:         " << variables << "\n";
+    std::cout << "flat id table:     " << lookups / flatSeconds / 1e6 << " M lookups/s\n";
+    std::cout << "unordered_map:     " << lookups / mapSeconds / 1e6 << " M lookups/s\n";
+    std::cout << "type check:        " << checkSeconds * 1000 << " ms for "
+              << 2 * variables << " statements, " << errors << " errors\n";
+    std::cout << "(checksums " << found << " " << mapFound << ")\n";
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+// Interpreter throughput and allocations on print- and string-heavy programs.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp interpreter/*.cpp bench/value_bench.cpp -o value_bench
+// ./value_bench [iterations]
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../interpreter/interpreter.hpp"
+#include "../util/alloc_counter.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <streambuf>
+
+// discards output but counts it, like a redirected stdout would see
+class CountingBuffer : public std::streambuf {
+public:
+    size_t bytes = 0;
+    
+protected:
+    int overflow(int c) override {
+        bytes += c != traits_type::eof();
+        return c;
+    }
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        bytes += n;
+        return n;
+    }
+};
+
+struct Workload {
+    const char* name;
+    std::string source;
+};
+
+static std::string loop(int iterations, const std::string& body, const std::string& setup = "",
+                        const std::string& after = "") {
+    return setup + "int i = 0;\nwhile (i < " + std::to_string(iterations) + ") {\n" + body +
+           "    i = i + 1;\n}\n" + after;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 200000;
+    std::vector<Workload> workloads = {
+        {"print", loop(n, "    print(\"iteration\", i, \"of\", 200000, \"ratio\", i / 3.0);\n")},
+        {"literals", loop(n, "    string a = \"a moderately long constant literal\";\n"
+                             "    if (a == \"a moderately long constant literal\") { print(a); }\n")},
+        {"concat", loop(n / 10, "    s = s + \"chunk\" + \", \";\n", "string s = \"\";\n",
+                        "print(s);\n")},
+        {"arithmetic", loop(n, "    sum = sum + i * 2 - i / 3;\n    f = f + 0.5;\n",
+                            "int sum = 0;\nfloat f = 0.0;\n", "print(sum, f);\n")},
+    };
+    
+    CountingBuffer counter;
+    std::ostream sink(&counter);
+    std::cout << std::left << std::setw(12) << "program" << std::right
+              << std::setw(10) << "ms" << std::setw(14) << "allocs" << std::setw(14) << "MiB alloc"
+              << std::setw(12) << "MiB out" << std::endl;
+    for (const Workload& workload : workloads) {
+        Lexer lexer(workload.source);
+        Parser parser(lexer.tokensize());
+        auto program = parser.parse();
+        
+        double best = 1e300;
+        AllocStats allocs;
+        size_t outputBytes = 0;
+        for (int run = 0; run < 3; ++run) {
+            size_t start = counter.bytes;
+            AllocStats before = allocStats();
+            auto t0 = std::chrono::steady_clock::now();
+            {
+                Interpreter interpreter(sink);
+                interpreter.run(program);
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            AllocStats after = allocStats();
+            allocs.allocations = after.allocations - before.allocations;
+            allocs.bytes = after.bytes - before.bytes;
+            outputBytes = counter.bytes - start;
+            best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+        std::cout << std::left << std::setw(12) << workload.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << best
+                  << std::setw(14) << allocs.allocations
+                  << std::setw(14) << allocs.bytes / 1048576.0
+                  << std::setw(12) << outputBytes / 1048576.0 << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "driver.hpp"
+#include "../semantic/type_checker.hpp"
+#include "../optimizer/call_graph.hpp"
+#include "../optimizer/program_passes.hpp"
+#include "../module/module_loader.hpp"
+#include "../interpreter/interpreter.hpp"
+#include "../instrument/instrumentation.hpp"
+#include <algorithm>
+#include <iterator>
+
+// replaces the imports with the functions of the modules, false on errors;
+// hasImports is set if there are any
+static bool loadImports(std::vector<std::unique_ptr<ASTNode>>& ast, std::ostream& out,
+                        std::ostream& err, const CompileOptions& options,
+                        StatementList& imported, bool& hasImports) {
+    for (const auto& stmt : ast) {
+        hasImports = hasImports || dynamic_cast<const ImportNode*>(stmt.get());
+    }
+    if (!hasImports) {
+        return true;
+    }
+    
+    out << "\n--- ИМПОРТ МОДУЛЕЙ ---" << std::endl;
+    ModuleLoader loader(options.pool, err);
+    loader.setLexerOptions(options.lexer);
+    {
+        ScopedPhase phase("import");
+        if (!loader.load(ast, options.directory.empty() ? "." : options.directory)) {
+            return false;
+        }
+        imported = loader.takeFunctions();
+    }
+    out << "Модулей: " << loader.moduleCount()
+        << ", из кэша: " << loader.cachedCount()
+        << ", функций: " << imported.size() << std::endl;
+    
+    ast.erase(std::remove_if(ast.begin(), ast.end(), [](const std::unique_ptr<ASTNode>& stmt) {
+        return dynamic_cast<const ImportNode*>(stmt.get()) != nullptr;
+    }), ast.end());
+    return true;
+}
+
+int compileSource(const std::string& code, std::ostream& out, std::ostream& err,
+                  const CompileOptions& options, bool* hasImports) {
+    bool unused;
+    bool& imports = hasImports ? *hasImports : unused;
+    imports = false;
+    try {
+        out << "--- ЛЕКСИЧЕСКИЙ АНАЛИЗ ---" << std::endl;
+        Lexer lexer(code, options.lexer);
+        std::vector<Token> tokens;
+        {
+            ScopedPhase phase("lex");
+            tokens = lexer.tokensize();
+        }
+        Instrumentation::instance().countTokens(tokens);
+        {
+            ScopedPhase phase("print tokens");
+            lexer.printTokens(tokens, out);
+        }
+        
+        out << "\n--- СИНТАКСИЧЕСКИЙ АНАЛИЗ ---" << std::endl;
+        Parser parser(tokens);
+        parser.setErrorStream(err);
+        std::vector<std::unique_ptr<ASTNode>> ast;
+        {
+            ScopedPhase phase("parse");
+            ast = parser.parse();
+        }
+        // the errors are reported already; what was parsed is not the program
+        if (parser.errorCount() > 0) {
+            return 1;
+        }
+        Instrumentation::instance().countNodes(ast);
+        {
+            ScopedPhase phase("print AST");
+            parser.printAST(ast, out);
+        }
+        
+        StatementList imported;
+        if (!loadImports(ast, out, err, options, imported, imports)) {
+            return 1;
+        }
+        
+        out << "\n--- СЕМАНТИЧЕСКИЙ АНАЛИЗ ---" << std::endl;
+        TypeChecker checker;
+        for (const auto& function : imported) {
+            checker.importFunction(static_cast<const FunctionDefNode*>(function.get()));
+        }
+        std::vector<Diagnostic> diagnostics;
+        {
+            ScopedPhase phase("type check");
+            diagnostics = checker.check(ast, options.pool);
+        }
+        if (!diagnostics.empty()) {
+            printDiagnostics(diagnostics, err);
+            return 1;
+        }
+        out << "Ошибок типов нет" << std::endl;
+        // checked when their modules were loaded; from here on they are
+        // functions of the program like any other
+        ast.insert(ast.begin(), std::make_move_iterator(imported.begin()),
+                   std::make_move_iterator(imported.end()));
+        
+        bool hasFunctions = false;
+        for (const auto& stmt : ast) {
+            hasFunctions = hasFunctions || dynamic_cast<const FunctionDefNode*>(stmt.get());
+        }
+        if (hasFunctions) {
+            out << "\n--- ГРАФ ВЫЗОВОВ ---" << std::endl;
+            size_t functions, calls, recursive = 0, removed;
+            {
+                ScopedPhase phase("call graph");
+                CallGraph graph(ast);
+                functions = graph.size() - 1;
+                calls = graph.edgeCount();
+                std::vector<bool> cycles = graph.recursive();
+                for (bool onCycle : cycles) {
+                    recursive += onCycle;
+                }
+                removed = removeUnreachableFunctions(ast);
+            }
+            out << "Функций: " << functions << ", вызовов: " << calls
+                << ", рекурсивных: " << recursive
+                << ", недостижимых удалено: " << removed << std::endl;
+        }
+        
+        out << "\n--- РАСПРОСТРАНЕНИЕ КОНСТАНТ ---" << std::endl;
+        ConstPropStats constStats;
+        {
+            ScopedPhase phase("constant propagation");
+            constStats = propagateConstants(ast, options.pool);
+        }
+        out << "Операторов: " << constStats.statementsBefore << " -> "
+            << constStats.statementsAfter
+            << ", подставлено констант: " << constStats.propagated
+            << ", свёрнуто выражений: " << constStats.folded
+            << ", разрешено ветвлений: " << constStats.branchesResolved
+            << ", недостижимых: " << constStats.unreachableRemoved
+            << ", мёртвых присваиваний: " << constStats.deadStoresRemoved
+            << ", лишних объявлений: " << constStats.declarationsRemoved << std::endl;
+        
+        out << "\n--- ОПТИМИЗАЦИЯ ЦИКЛОВ ---" << std::endl;
+        LoopOptStats loopStats;
+        {
+            ScopedPhase phase("loop optimization");
+            loopStats = optimizeLoops(ast, options.pool);
+        }
+        out << "Циклов: " << loopStats.loops
+            << ", индуктивных переменных: " << loopStats.inductionVariables
+            << ", вынесено выражений: " << loopStats.hoisted
+            << ", снижено умножений: " << loopStats.strengthReduced << std::endl;
+        {
+            ScopedPhase phase("print optimized AST");
+            parser.printAST(ast, out);
+        }
+        
+        out << "\n--- ВЫПОЛНЕНИЕ ---" << std::endl;
+        Interpreter interpreter(out);
+        interpreter.setProfiler(options.profiler);
+        {
+            ScopedPhase phase("run");
+            interpreter.run(ast);
+        }
+    } catch (const RuntimeError& e) {
+        err << "Ошибка в строке " << e.line() << ": " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        err << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
+
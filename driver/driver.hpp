@@ -0,0 +1,29 @@
+#ifndef DRIVER_HPP
+#define DRIVER_HPP
+
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../interpreter/profiler.hpp"
+#include "../util/thread_pool.hpp"
+
+struct CompileOptions {
+    LexerOptions lexer;
+    Profiler* profiler;     // profiles the execution phase when set
+    // runs imports and function bodies in parallel when set; must not be the
+    // pool running this call (wait() would wait for itself)
+    ThreadPool* pool;
+    std::string directory;  // imports are relative to it, "." when empty
+    
+    CompileOptions() : profiler(nullptr), pool(nullptr) {}
+};
+
+// Full pipeline: tokens, AST, imports, type check, optimizations, execution.
+// Listings and program output go to out, diagnostics to err. hasImports,
+// when given, is set if the program imports modules: its result then
+// depends on files other than code.
+// Returns the process exit status (0 on success).
+int compileSource(const std::string& code, std::ostream& out, std::ostream& err,
+                  const CompileOptions& options = CompileOptions(),
+                  bool* hasImports = nullptr);
+
+#endif
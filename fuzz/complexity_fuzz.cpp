@@ -0,0 +1,454 @@
+// Complexity fuzzer for the lexer and parser, no libFuzzer needed.
+// Mutates small inputs, splits each into prefix + pump + suffix and measures
+// how the work grows as the pump is repeated: a log-log slope well above 1
+// means superlinear cost. Such inputs are minimized and saved, pumped to
+// --save-size bytes, as a perf regression corpus; crashes and stack overflows
+// are saved as crash-*.txt. --check=DIR replays a corpus against a budget.
+// g++ -std=c++11 -O2 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp fuzz/work_counter.cpp fuzz/frontend_target.cpp fuzz/complexity_fuzz.cpp -o complexity_fuzz
+// ./complexity_fuzz [--iterations=N] [--seed=N] [--max-len=BYTES] [--threshold=SLOPE]
+//                   [--dict=FILE] [--corpus=DIR]... [--save=DIR] [--save-size=BYTES]
+// ./complexity_fuzz --check=fuzz/corpus/perf [--budget=RATIO]
+#include "frontend_target.hpp"
+#include "work_counter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <pthread.h>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct FuzzOptions {
+    size_t iterations;
+    uint32_t seed;
+    size_t maxLength;       // of mutated inputs before pumping
+    double threshold;       // slopes above this are superlinear
+    std::string dictPath;
+    std::vector<std::string> corpusDirs;
+    std::string saveDir;
+    size_t saveSize;
+    std::string checkDir;
+    double budget;          // --check: allowed work per byte, relative to a plain program
+
+    FuzzOptions()
+        : iterations(2000), seed(1), maxLength(256), threshold(1.5),
+          dictPath("fuzz/frontend.dict"), saveDir("fuzz/corpus/perf"),
+          saveSize(32768), budget(4) {}
+};
+
+// input = prefix + pump * k + suffix
+struct PumpedInput {
+    std::string prefix;
+    std::string pump;
+    std::string suffix;
+
+    std::string build(size_t targetBytes) const {
+        std::string out = prefix;
+        do {
+            out += pump;
+        } while (out.size() + suffix.size() < targetBytes);
+        return out + suffix;
+    }
+    std::string key() const { return prefix + '\0' + pump + '\0' + suffix; }
+};
+
+static WorkCounter counter;
+
+// --- crash and stack overflow detection -------------------------------------
+
+static const std::string* currentInput = nullptr;
+static char crashDir[512];
+static uintptr_t stackLow = 0;  // lowest address of the main thread's stack
+
+static void writeString(int fd, const char* text) {
+    ssize_t ignored = write(fd, text, std::strlen(text));
+    (void)ignored;
+}
+
+// only async-signal-safe calls: the heap may be corrupt
+static void crashHandler(int signal, siginfo_t* info, void*) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(info->si_addr);
+    bool stackOverflow = signal == SIGSEGV && stackLow != 0 &&
+                         address + (1 << 20) >= stackLow && address < stackLow + (64 << 10);
+    writeString(2, stackOverflow ? "\n==stack overflow" : "\n==crash");
+    writeString(2, signal == SIGSEGV ? " (SIGSEGV)\n" : signal == SIGABRT ? " (SIGABRT)\n" : " (signal)\n");
+
+    if (currentInput) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : *currentInput) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+        char path[600];
+        std::strcpy(path, crashDir);
+        std::strcat(path, "/crash-");
+        size_t end = std::strlen(path);
+        for (int i = 0; i < 16; ++i) {
+            path[end + i] = "0123456789abcdef"[(hash >> (60 - 4 * i)) & 15];
+        }
+        std::strcpy(path + end + 16, ".txt");
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            ssize_t ignored = write(fd, currentInput->data(), currentInput->size());
+            (void)ignored;
+            close(fd);
+            writeString(2, "==input saved to ");
+            writeString(2, path);
+            writeString(2, "\n");
+        }
+    }
+    _exit(1);
+}
+
+static void installCrashHandler(const std::string& dir) {
+    std::snprintf(crashDir, sizeof(crashDir), "%s", dir.c_str());
+
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        void* base;
+        size_t size;
+        pthread_attr_getstack(&attr, &base, &size);
+        stackLow = reinterpret_cast<uintptr_t>(base);
+        pthread_attr_destroy(&attr);
+    }
+
+    // the handler cannot run on the stack that just overflowed
+    static std::vector<char> alternateStack(1 << 16);
+    stack_t stack;
+    stack.ss_sp = alternateStack.data();
+    stack.ss_size = alternateStack.size();
+    stack.ss_flags = 0;
+    sigaltstack(&stack, nullptr);
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = crashHandler;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigaction(SIGSEGV, &action, nullptr);
+    sigaction(SIGBUS, &action, nullptr);
+    sigaction(SIGABRT, &action, nullptr);
+    sigaction(SIGFPE, &action, nullptr);
+}
+
+// --- measurement --------------------------------------------------------------
+
+// least work over several runs, the others are noise
+static uint64_t measure(const std::string& input, int runs) {
+    uint64_t best = UINT64_MAX;
+    currentInput = &input;
+    for (int i = 0; i < runs; ++i) {
+        counter.start();
+        runFrontend(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+        best = std::min(best, counter.stop());
+    }
+    currentInput = nullptr;
+    return std::max<uint64_t>(best, 1);
+}
+
+// growth exponent of work between two pumped sizes
+static double slope(const PumpedInput& input, size_t smallBytes, size_t largeBytes, int runs) {
+    std::string small = input.build(smallBytes);
+    std::string large = input.build(largeBytes);
+    if (large.size() <= small.size() * 2) {
+        return 0;
+    }
+    double work = double(measure(large, runs)) / measure(small, runs);
+    return std::log(work) / std::log(double(large.size()) / small.size());
+}
+
+static bool superlinear(const PumpedInput& input, const FuzzOptions& options) {
+    return slope(input, 4096, 65536, 3) > options.threshold;
+}
+
+// --- corpus, dictionary, mutation ----------------------------------------------
+
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+static std::vector<std::string> listFiles(const std::string& dir) {
+    std::vector<std::string> files;
+    if (DIR* handle = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(handle)) {
+            if (entry->d_name[0] != '.') {
+                files.push_back(dir + "/" + entry->d_name);
+            }
+        }
+        closedir(handle);
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// libFuzzer dictionary format: "token" per line, \\ \" \xNN escapes
+static std::vector<std::string> loadDictionary(const std::string& path) {
+    std::vector<std::string> tokens;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t open = line.find('"');
+        size_t close = line.rfind('"');
+        if (line.empty() || line[0] == '#' || open == std::string::npos || close <= open) {
+            continue;
+        }
+        std::string token;
+        for (size_t i = open + 1; i < close; ++i) {
+            if (line[i] == '\\' && i + 1 < close) {
+                ++i;
+                if (line[i] == 'x' && i + 2 < close) {
+                    token += static_cast<char>(std::strtol(line.substr(i + 1, 2).c_str(), nullptr, 16));
+                    i += 2;
+                    continue;
+                }
+            }
+            token += line[i];
+        }
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+class Mutator {
+private:
+    std::mt19937 rng;
+    const std::vector<std::string>& dictionary;
+
+    size_t below(size_t n) { return n == 0 ? 0 : rng() % n; }
+
+public:
+    Mutator(uint32_t seed, const std::vector<std::string>& dict) : rng(seed), dictionary(dict) {}
+
+    size_t random(size_t n) { return below(n); }
+
+    std::string mutate(std::string input, const std::vector<std::string>& corpus, size_t maxLength) {
+        int steps = 1 + below(4);
+        for (int step = 0; step < steps; ++step) {
+            size_t position = below(input.size() + 1);
+            switch (below(6)) {
+                case 0:
+                    input.insert(position, dictionary[below(dictionary.size())]);
+                    break;
+                case 1:
+                    input.erase(position, 1 + below(8));
+                    break;
+                case 2: {
+                    std::string chunk = input.substr(below(input.size() + 1), 1 + below(16));
+                    input.insert(position, chunk);
+                    break;
+                }
+                case 3:
+                    if (!input.empty()) {
+                        input[below(input.size())] = below(8) == 0 ? '\n' : char(' ' + below(95));
+                    }
+                    break;
+                case 4: {
+                    const std::string& other = corpus[below(corpus.size())];
+                    input.insert(position, other.substr(below(other.size() + 1), 1 + below(32)));
+                    break;
+                }
+                default: {
+                    const std::string& token = dictionary[below(dictionary.size())];
+                    for (size_t i = 2 + below(7); i > 0; --i) {
+                        input.insert(position, token);
+                    }
+                    break;
+                }
+            }
+        }
+        if (input.size() > maxLength) {
+            input.resize(maxLength);
+        }
+        return input;
+    }
+
+    // the whole input as the pump, or a random slice of it
+    PumpedInput split(const std::string& input) {
+        PumpedInput result;
+        if (below(4) == 0) {
+            result.pump = input;
+            return result;
+        }
+        size_t first = below(input.size());
+        size_t last = first + 1 + below(input.size() - first);
+        result.prefix = input.substr(0, first);
+        result.pump = input.substr(first, last - first);
+        result.suffix = input.substr(last);
+        return result;
+    }
+};
+
+// Shortest prefix, pump and suffix that still grow superlinearly.
+static PumpedInput minimize(PumpedInput input, const FuzzOptions& options) {
+    std::string PumpedInput::*parts[] = {&PumpedInput::suffix, &PumpedInput::prefix, &PumpedInput::pump};
+    for (std::string PumpedInput::*part : parts) {
+        for (size_t chunk = std::max<size_t>((input.*part).size() / 2, 1); chunk > 0; chunk /= 2) {
+            for (size_t start = 0; start < (input.*part).size();) {
+                PumpedInput candidate = input;
+                (candidate.*part).erase(start, chunk);
+                if (!candidate.pump.empty() && superlinear(candidate, options)) {
+                    input = candidate;
+                } else {
+                    start += chunk;
+                }
+            }
+        }
+    }
+    return input;
+}
+
+static std::string escape(const std::string& text, size_t limit = 40) {
+    std::string out;
+    for (size_t i = 0; i < text.size() && i < limit; ++i) {
+        unsigned char c = text[i];
+        if (c == '\n') out += "\\n";
+        else if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (c < ' ' || c >= 0x7F) {
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "\\x%02x", c);
+            out += hex;
+        } else out += c;
+    }
+    return text.size() > limit ? out + "..." : out;
+}
+
+static std::string hexHash(const std::string& data) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : data) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    char text[20];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+// --- modes -------------------------------------------------------------------
+
+static int fuzz(const FuzzOptions& options) {
+    std::vector<std::string> dictionary = loadDictionary(options.dictPath);
+    if (dictionary.empty()) {
+        std::cerr << "Словарь пуст или не найден: " << options.dictPath << std::endl;
+        return 1;
+    }
+    std::vector<std::string> corpus(dictionary);
+    for (const std::string& dir : options.corpusDirs) {
+        for (const std::string& path : listFiles(dir)) {
+            std::string input = readFile(path);
+            corpus.push_back(input.substr(0, options.maxLength));
+        }
+    }
+
+    Mutator mutator(options.seed, dictionary);
+    std::set<std::string> known;
+    size_t findings = 0;
+    std::vector<double> keptSlopes;
+
+    for (size_t iteration = 1; iteration <= options.iterations; ++iteration) {
+        std::string input = mutator.mutate(corpus[mutator.random(corpus.size())], corpus, options.maxLength);
+        if (input.empty()) {
+            continue;
+        }
+        measure(input, 1);  // plain run first: crashes show up on the small input
+
+        PumpedInput candidate = mutator.split(input);
+        double quick = slope(candidate, 2048, 16384, 1);
+
+        // slope-guided: keep inputs that grow at least as steeply as most of the corpus
+        std::vector<double> sorted(keptSlopes);
+        std::sort(sorted.begin(), sorted.end());
+        double median = sorted.empty() ? 0 : sorted[sorted.size() / 2];
+        if (quick >= median || mutator.random(20) == 0) {
+            corpus.push_back(input);
+            keptSlopes.push_back(quick);
+        }
+
+        if (quick > options.threshold && superlinear(candidate, options)) {
+            PumpedInput minimal = minimize(candidate, options);
+            // timing noise passes a single check now and then
+            double confirmed = slope(minimal, 4096, 65536, 5);
+            if (confirmed <= options.threshold || !known.insert(minimal.key()).second) {
+                continue;
+            }
+            std::string saved = minimal.build(options.saveSize);
+            std::string path = options.saveDir + "/slow-" + hexHash(saved) + ".txt";
+            std::ofstream(path, std::ios::binary) << saved;
+            ++findings;
+            std::cout << std::fixed << std::setprecision(2)
+                      << "[" << iteration << "] superlinear, slope " << confirmed
+                      << ": prefix \"" << escape(minimal.prefix) << "\" pump \"" << escape(minimal.pump)
+                      << "\" suffix \"" << escape(minimal.suffix) << "\" -> " << path << std::endl;
+        }
+        if (iteration % 500 == 0) {
+            std::cerr << "итераций " << iteration << ", корпус " << corpus.size()
+                      << ", найдено " << findings << std::endl;
+        }
+    }
+    std::cout << "найдено сверхлинейных входов: " << findings << std::endl;
+    return findings == 0 ? 0 : 1;
+}
+
+// Work per byte of every corpus file relative to a plain program of the
+// same size; a fixed regression shows up as a ratio near 1.
+static int check(const FuzzOptions& options) {
+    const std::string unit = "int a = 1 + 2 * 3;\nwhile (a < 10) { a = a + 1; }\nprint(\"a\", a);\n";
+    int failures = 0;
+    std::vector<std::string> files = listFiles(options.checkDir);
+    for (const std::string& path : files) {
+        std::string input = readFile(path);
+        std::string reference;
+        while (reference.size() < input.size()) {
+            reference += unit;
+        }
+        double perByte = double(measure(input, 3)) / std::max<size_t>(input.size(), 1);
+        double referencePerByte = double(measure(reference, 3)) / std::max<size_t>(reference.size(), 1);
+        double ratio = perByte / referencePerByte;
+        bool failed = ratio > options.budget;
+        failures += failed;
+        std::cout << (failed ? "FAIL " : "ok   ") << std::fixed << std::setprecision(1)
+                  << std::setw(9) << perByte << " " << counter.unit() << "/byte  x"
+                  << std::setw(6) << ratio << "  " << path << std::endl;
+    }
+    std::cout << files.size() << " файлов, превышений бюджета x" << options.budget
+              << ": " << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    FuzzOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t equals = arg.find('=');
+        std::string name = arg.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+        if (name == "--iterations") options.iterations = std::strtoul(value.c_str(), nullptr, 10);
+        else if (name == "--seed") options.seed = std::strtoul(value.c_str(), nullptr, 10);
+        else if (name == "--max-len") options.maxLength = std::strtoul(value.c_str(), nullptr, 10);
+        else if (name == "--threshold") options.threshold = std::atof(value.c_str());
+        else if (name == "--dict") options.dictPath = value;
+        else if (name == "--corpus") options.corpusDirs.push_back(value);
+        else if (name == "--save") options.saveDir = value;
+        else if (name == "--save-size") options.saveSize = std::strtoul(value.c_str(), nullptr, 10);
+        else if (name == "--check") options.checkDir = value;
+        else if (name == "--budget") options.budget = std::atof(value.c_str());
+        else {
+            std::cerr << "Неизвестный аргумент: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    std::cerr << "единица работы: " << counter.unit() << std::endl;
+    installCrashHandler(options.saveDir);
+    return options.checkDir.empty() ? fuzz(options) : check(options);
+}
@@ -0,0 +1,30 @@
+// Coverage-guided libFuzzer target for the lexer and parser. Besides
+// crashes (ASan reports stack overflows), an input fails when its work per
+// byte exceeds FUZZ_WORK_PER_BYTE (default 20000 instructions, or ns when
+// hardware counters are unavailable), which is how superlinear cases surface.
+// clang++ -std=c++11 -g -O1 -fsanitize=fuzzer,address lexer/lexer.cpp parser/pars.cpp util/*.cpp fuzz/work_counter.cpp fuzz/frontend_target.cpp fuzz/frontend_fuzzer.cpp -o frontend_fuzzer
+// ./frontend_fuzzer -dict=fuzz/frontend.dict -max_len=65536 fuzz/corpus/perf
+#include "frontend_target.hpp"
+#include "work_counter.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+// inputs shorter than this are dominated by fixed costs
+static const size_t MIN_MEASURED_SIZE = 256;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static WorkCounter counter;
+    static const char* limitVariable = std::getenv("FUZZ_WORK_PER_BYTE");
+    static const double limit = limitVariable ? std::atof(limitVariable) : 20000;
+    
+    counter.start();
+    runFrontend(data, size);
+    uint64_t work = counter.stop();
+    
+    if (size >= MIN_MEASURED_SIZE && work > limit * size) {
+        std::fprintf(stderr, "==%zu bytes: %.0f %s/byte, limit %.0f\n",
+                     size, double(work) / size, counter.unit(), limit);
+        std::abort();  // libFuzzer saves the input as crash-<sha1>
+    }
+    return 0;
+}
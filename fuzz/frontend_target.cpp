@@ -0,0 +1,25 @@
+#include "frontend_target.hpp"
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include <stdexcept>
+
+size_t runFrontend(const uint8_t* data, size_t size) {
+    std::string source(reinterpret_cast<const char*>(data), size);
+    std::ostream discard(nullptr);
+    try {
+        Lexer lexer(source);
+        std::vector<Token> tokens = lexer.tokensize();
+        Parser parser(tokens);
+        parser.setErrorStream(discard);
+        std::vector<std::unique_ptr<ASTNode>> ast = parser.parse();
+        
+        std::string dump;
+        for (const auto& node : ast) {
+            node->writeTo(dump);
+            dump += '\n';
+        }
+        return dump.size();
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef FRONTEND_TARGET_HPP
+#define FRONTEND_TARGET_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Lexer, Parser and the AST dump on arbitrary bytes, the way the driver
+// runs them. Syntax errors go to a discarding stream; malformed UTF-8 and
+// other rejected input are expected and not reported.
+// Returns the size of the AST dump so the work cannot be optimized away.
+size_t runFrontend(const uint8_t* data, size_t size);
+
+#endif
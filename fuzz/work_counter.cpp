@@ -0,0 +1,45 @@
+#include "work_counter.hpp"
+#include <cstring>
+#include <ctime>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+WorkCounter::WorkCounter() : fd(-1), startValue(0) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // fails without a PMU (most VMs) or with perf_event_paranoid > 2
+    fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+WorkCounter::~WorkCounter() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+uint64_t WorkCounter::read() const {
+    if (fd >= 0) {
+        uint64_t count = 0;
+        if (::read(fd, &count, sizeof(count)) == sizeof(count)) {
+            return count;
+        }
+    }
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return uint64_t(now.tv_sec) * 1000000000ull + now.tv_nsec;
+}
+
+void WorkCounter::start() {
+    startValue = read();
+}
+
+uint64_t WorkCounter::stop() {
+    return read() - startValue;
+}
@@ -0,0 +1,28 @@
+#ifndef WORK_COUNTER_HPP
+#define WORK_COUNTER_HPP
+
+#include <cstdint>
+
+// Work done by the calling thread: retired user-space instructions from
+// perf_event_open when the kernel allows it, otherwise thread CPU time in ns.
+class WorkCounter {
+private:
+    int fd;
+    uint64_t startValue;
+    
+    uint64_t read() const;
+    
+public:
+    WorkCounter();
+    ~WorkCounter();
+    WorkCounter(const WorkCounter&) = delete;
+    WorkCounter& operator=(const WorkCounter&) = delete;
+    
+    bool countsInstructions() const { return fd >= 0; }
+    const char* unit() const { return fd >= 0 ? "instr" : "ns"; }
+    
+    void start();
+    uint64_t stop();  // work since start()
+};
+
+#endif
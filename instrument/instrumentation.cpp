@@ -0,0 +1,195 @@
+#include "instrumentation.hpp"
+#include "../optimizer/ast_utils.hpp"
+#include "../util/alloc_counter.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock Clock;
+
+static const char* nodeKindName(const ASTNode& node) {
+    if (dynamic_cast<const NumberNode*>(&node)) return "Number";
+    if (dynamic_cast<const StringNode*>(&node)) return "String";
+    if (dynamic_cast<const IdentifierNode*>(&node)) return "Identifier";
+    if (dynamic_cast<const BinaryOpNode*>(&node)) return "BinaryOp";
+    if (dynamic_cast<const VarDeclarationNode*>(&node)) return "VarDecl";
+    if (dynamic_cast<const AssignmentNode*>(&node)) return "Assignment";
+    if (dynamic_cast<const IfNode*>(&node)) return "If";
+    if (dynamic_cast<const WhileNode*>(&node)) return "While";
+    if (dynamic_cast<const BlockNode*>(&node)) return "Block";
+    if (dynamic_cast<const FunctionCallNode*>(&node)) return "Call";
+    if (dynamic_cast<const FunctionDefNode*>(&node)) return "Function";
+    if (dynamic_cast<const ReturnNode*>(&node)) return "Return";
+    if (dynamic_cast<const ImportNode*>(&node)) return "Import";
+    return "Unknown";
+}
+
+static std::string jsonEscape(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+Instrumentation::Instrumentation() : active(false), processPeakKb(0) {}
+
+Instrumentation& Instrumentation::instance() {
+    static Instrumentation instrumentation;
+    return instrumentation;
+}
+
+void Instrumentation::enable() {
+    active = true;
+    origin = Clock::now();
+    setAllocCounting(true);
+}
+
+double Instrumentation::nowUs() const {
+    return std::chrono::duration<double, std::micro>(Clock::now() - origin).count();
+}
+
+// Bills the kernel high-water mark since the last reset to the innermost open
+// phase, so every phase ends up with the peak reached while it ran.
+void Instrumentation::notePeakRss() {
+    size_t peak = peakRssKb();
+    processPeakKb = std::max(processPeakKb, peak);
+    if (!openPhases.empty()) {
+        PhaseRecord& current = phases[openPhases.back()];
+        current.peakRssKb = std::max(current.peakRssKb, peak);
+    }
+}
+
+size_t Instrumentation::processPeakRssKb() const {
+    return std::max(processPeakKb, peakRssKb());
+}
+
+size_t Instrumentation::beginPhase(const char* name) {
+    notePeakRss();
+    resetPeakRss();
+    AllocStats alloc = allocStats();
+    PhaseRecord record;
+    record.name = name;
+    record.depth = static_cast<int>(openPhases.size());
+    record.allocations = alloc.allocations;
+    record.allocatedBytes = alloc.bytes;
+    record.peakRssKb = 0;
+    record.durationUs = 0;
+    phases.push_back(record);
+    openPhases.push_back(phases.size() - 1);
+    // taken last so the bookkeeping above is not billed to the phase
+    phases.back().startUs = nowUs();
+    return phases.size() - 1;
+}
+
+void Instrumentation::endPhase(size_t index) {
+    double end = nowUs();
+    AllocStats alloc = allocStats();
+    PhaseRecord& record = phases[index];
+    record.durationUs = end - record.startUs;
+    record.allocations = alloc.allocations - record.allocations;
+    record.allocatedBytes = alloc.bytes - record.allocatedBytes;
+    notePeakRss();
+    openPhases.pop_back();
+    if (!openPhases.empty()) {
+        PhaseRecord& parent = phases[openPhases.back()];
+        parent.peakRssKb = std::max(parent.peakRssKb, record.peakRssKb);
+    }
+}
+
+void Instrumentation::countTokens(const std::vector<Token>& tokens) {
+    if (!active) {
+        return;
+    }
+    for (const auto& token : tokens) {
+        tokenCounts[tokenTypeName(token.type)]++;
+    }
+}
+
+void Instrumentation::countNodes(std::vector<std::unique_ptr<ASTNode>>& ast) {
+    if (!active) {
+        return;
+    }
+    forEachNode(ast, [&](ASTNode& node) {
+        nodeCounts[nodeKindName(node)]++;
+    });
+}
+
+void Instrumentation::printTimeReport(std::ostream& out) const {
+    out << "\n=== TIME REPORT ===\n\n";
+    char line[200];
+    snprintf(line, sizeof(line), "%-28s %12s %10s %14s %12s\n",
+             "phase", "time ms", "allocs", "alloc bytes", "peak RSS KiB");
+    out << line;
+    for (const auto& phase : phases) {
+        std::string name = std::string(phase.depth * 2, ' ') + phase.name;
+        snprintf(line, sizeof(line), "%-28s %12.3f %10zu %14zu %12zu\n",
+                 name.c_str(), phase.durationUs / 1000.0, phase.allocations,
+                 phase.allocatedBytes, phase.peakRssKb);
+        out << line;
+    }
+}
+
+void Instrumentation::printStats(std::ostream& out) const {
+    out << "\n=== STATS ===\n\nTokens by type:\n";
+    for (const auto& entry : tokenCounts) {
+        out << "  " << entry.first << ": " << entry.second << "\n";
+    }
+    out << "AST nodes by kind:\n";
+    for (const auto& entry : nodeCounts) {
+        out << "  " << entry.first << ": " << entry.second << "\n";
+    }
+    AllocStats alloc = allocStats();
+    out << "Allocations: " << alloc.allocations << " (" << alloc.bytes << " bytes)\n";
+    out << "Peak RSS: " << processPeakRssKb() << " KiB\n";
+}
+
+void Instrumentation::printJson(std::ostream& out) const {
+    out << "{\n  \"phases\": [\n";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const PhaseRecord& phase = phases[i];
+        out << "    {\"name\": \"" << jsonEscape(phase.name) << "\", \"depth\": " << phase.depth
+            << ", \"ms\": " << phase.durationUs / 1000.0
+            << ", \"allocations\": " << phase.allocations
+            << ", \"allocated_bytes\": " << phase.allocatedBytes
+            << ", \"peak_rss_kb\": " << phase.peakRssKb << "}"
+            << (i + 1 < phases.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"tokens\": {";
+    bool first = true;
+    for (const auto& entry : tokenCounts) {
+        out << (first ? "" : ", ") << "\"" << entry.first << "\": " << entry.second;
+        first = false;
+    }
+    out << "},\n  \"nodes\": {";
+    first = true;
+    for (const auto& entry : nodeCounts) {
+        out << (first ? "" : ", ") << "\"" << entry.first << "\": " << entry.second;
+        first = false;
+    }
+    AllocStats alloc = allocStats();
+    out << "},\n  \"allocations\": " << alloc.allocations
+        << ",\n  \"allocated_bytes\": " << alloc.bytes
+        << ",\n  \"peak_rss_kb\": " << processPeakRssKb() << "\n}\n";
+}
+
+bool Instrumentation::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "{\"traceEvents\": [\n";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const PhaseRecord& phase = phases[i];
+        out << "  {\"name\": \"" << jsonEscape(phase.name) << "\", \"cat\": \"compiler\""
+            << ", \"ph\": \"X\", \"ts\": " << phase.startUs << ", \"dur\": " << phase.durationUs
+            << ", \"pid\": " << getpid() << ", \"tid\": 1"
+            << ", \"args\": {\"allocations\": " << phase.allocations
+            << ", \"allocated_bytes\": " << phase.allocatedBytes << "}}"
+            << (i + 1 < phases.size() ? ",\n" : "\n");
+    }
+    out << "], \"displayTimeUnit\": \"ms\"}\n";
+    return true;
+}
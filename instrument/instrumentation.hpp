@@ -0,0 +1,76 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include <chrono>
+#include <map>
+
+struct PhaseRecord {
+    std::string name;
+    int depth;              // nesting level, 0 = top-level phase
+    double startUs;         // since Instrumentation::enable()
+    double durationUs;
+    size_t allocations;
+    size_t allocatedBytes;
+    size_t peakRssKb;       // highest RSS while the phase ran, its sub-phases included
+};
+
+// Per-phase timers, token/node counters and allocation statistics of the
+// driver. Everything is a no-op until enable() is called, so the only cost
+// of a disabled ScopedPhase is one branch.
+class Instrumentation {
+private:
+    bool active;
+    std::chrono::steady_clock::time_point origin;
+    std::vector<PhaseRecord> phases;
+    std::vector<size_t> openPhases;
+    size_t processPeakKb;   // the kernel high-water mark is reset per phase
+    std::map<std::string, size_t> tokenCounts;
+    std::map<std::string, size_t> nodeCounts;
+    
+    Instrumentation();
+    double nowUs() const;
+    void notePeakRss();
+    size_t processPeakRssKb() const;
+    
+public:
+    static Instrumentation& instance();
+    
+    void enable();
+    bool enabled() const { return active; }
+    
+    size_t beginPhase(const char* name);
+    void endPhase(size_t index);
+    
+    void countTokens(const std::vector<Token>& tokens);
+    void countNodes(std::vector<std::unique_ptr<ASTNode>>& ast);
+    
+    void printTimeReport(std::ostream& out) const;
+    void printStats(std::ostream& out) const;
+    void printJson(std::ostream& out) const;
+    // Chrome trace-event format, opens in chrome://tracing or Perfetto
+    bool writeChromeTrace(const std::string& path) const;
+};
+
+class ScopedPhase {
+private:
+    bool active;
+    size_t index;
+    
+public:
+    explicit ScopedPhase(const char* name)
+        : active(Instrumentation::instance().enabled()), index(0) {
+        if (active) {
+            index = Instrumentation::instance().beginPhase(name);
+        }
+    }
+    
+    ~ScopedPhase() {
+        if (active) {
+            Instrumentation::instance().endPhase(index);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,22 @@
+#include "constant_pool.hpp"
+
+const Value& ConstantPool::number(const NumberNode* node) {
+    auto it = byNode.find(node);
+    if (it == byNode.end()) {
+        it = byNode.insert(std::make_pair(node, parseNumberLiteral(node->value))).first;
+    }
+    return it->second;
+}
+
+const Value& ConstantPool::string(const StringNode* node) {
+    auto it = byNode.find(node);
+    if (it != byNode.end()) {
+        return it->second;
+    }
+    auto pooled = strings.find(node->value);
+    if (pooled == strings.end()) {
+        Value value = Value::fromRope(RopeString::borrow(node->value));
+        pooled = strings.insert(std::make_pair(node->value, value)).first;
+    }
+    return byNode.insert(std::make_pair(node, pooled->second)).first->second;
+}
@@ -0,0 +1,24 @@
+#ifndef CONSTANT_POOL_HPP
+#define CONSTANT_POOL_HPP
+
+#include "../parser/parser.hpp"
+#include "value.hpp"
+#include <string>
+#include <unordered_map>
+
+// Runtime values of the literals in a program, built on first use. Equal
+// string literals share one RopeString that borrows the characters of the
+// first StringNode, so evaluating a literal copies nothing. The AST must
+// outlive the pool.
+class ConstantPool {
+private:
+    std::unordered_map<const ASTNode*, Value> byNode;
+    std::unordered_map<std::string, Value> strings;
+    
+public:
+    const Value& number(const NumberNode* node);
+    const Value& string(const StringNode* node);
+    size_t stringCount() const { return strings.size(); }
+};
+
+#endif
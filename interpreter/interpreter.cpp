@@ -0,0 +1,338 @@
+#include "interpreter.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+const size_t Interpreter::MAX_CALL_DEPTH;
+
+Interpreter::Interpreter(std::ostream& output)
+    : out(output), profiler(nullptr), returning(false), callDepth(0) {}
+
+static void collectDeclarations(const std::vector<std::unique_ptr<ASTNode>>& body,
+                                std::vector<SymbolId>& names) {
+    for (const auto& stmt : body) {
+        if (auto decl = dynamic_cast<const VarDeclarationNode*>(stmt.get())) {
+            names.push_back(decl->name);
+        } else if (auto ifNode = dynamic_cast<const IfNode*>(stmt.get())) {
+            collectDeclarations(ifNode->thenBody, names);
+            collectDeclarations(ifNode->elseBody, names);
+        } else if (auto whileNode = dynamic_cast<const WhileNode*>(stmt.get())) {
+            collectDeclarations(whileNode->body, names);
+        } else if (auto block = dynamic_cast<const BlockNode*>(stmt.get())) {
+            collectDeclarations(block->statements, names);
+        }
+    }
+}
+
+// largest name the program uses; the interner may hold far more (a server
+// keeps the names of every request), none of which need a variable here
+static void findMaxName(const ASTNode* node, SymbolId& max) {
+    if (!node) {
+        return;
+    }
+    if (auto ident = dynamic_cast<const IdentifierNode*>(node)) {
+        max = std::max(max, ident->name);
+    } else if (auto binary = dynamic_cast<const BinaryOpNode*>(node)) {
+        findMaxName(binary->left.get(), max);
+        findMaxName(binary->right.get(), max);
+    } else if (auto conversion = dynamic_cast<const IntToFloatNode*>(node)) {
+        findMaxName(conversion->operand.get(), max);
+    } else if (auto call = dynamic_cast<const FunctionCallNode*>(node)) {
+        for (const auto& arg : call->arguments) {
+            findMaxName(arg.get(), max);
+        }
+    } else if (auto decl = dynamic_cast<const VarDeclarationNode*>(node)) {
+        max = std::max(max, decl->name);
+        findMaxName(decl->initializer.get(), max);
+    } else if (auto assign = dynamic_cast<const AssignmentNode*>(node)) {
+        max = std::max(max, assign->name);
+        findMaxName(assign->value.get(), max);
+    } else if (auto ifNode = dynamic_cast<const IfNode*>(node)) {
+        findMaxName(ifNode->condition.get(), max);
+        for (const auto& stmt : ifNode->thenBody) {
+            findMaxName(stmt.get(), max);
+        }
+        for (const auto& stmt : ifNode->elseBody) {
+            findMaxName(stmt.get(), max);
+        }
+    } else if (auto whileNode = dynamic_cast<const WhileNode*>(node)) {
+        findMaxName(whileNode->condition.get(), max);
+        for (const auto& stmt : whileNode->body) {
+            findMaxName(stmt.get(), max);
+        }
+    } else if (auto block = dynamic_cast<const BlockNode*>(node)) {
+        for (const auto& stmt : block->statements) {
+            findMaxName(stmt.get(), max);
+        }
+    } else if (auto ret = dynamic_cast<const ReturnNode*>(node)) {
+        findMaxName(ret->value.get(), max);
+    } else if (auto function = dynamic_cast<const FunctionDefNode*>(node)) {
+        for (const auto& parameter : function->parameters) {
+            max = std::max(max, parameter.name);
+        }
+        for (const auto& stmt : function->body) {
+            findMaxName(stmt.get(), max);
+        }
+    }
+}
+
+// functions can be called before their definition, so all are known up front
+void Interpreter::collectFunctions(const std::vector<std::unique_ptr<ASTNode>>& program) {
+    for (const auto& stmt : program) {
+        auto definition = dynamic_cast<const FunctionDefNode*>(stmt.get());
+        if (!definition) {
+            continue;
+        }
+        if (definition->name >= functions.size()) {
+            functions.resize(definition->name + 1);
+        }
+        Function& function = functions[definition->name];
+        function.definition = definition;
+        function.locals.clear();
+        for (const auto& parameter : definition->parameters) {
+            function.locals.push_back(parameter.name);
+        }
+        collectDeclarations(definition->body, function.locals);
+        std::sort(function.locals.begin(), function.locals.end());
+        function.locals.erase(std::unique(function.locals.begin(), function.locals.end()),
+                              function.locals.end());
+    }
+}
+
+void Interpreter::run(const std::vector<std::unique_ptr<ASTNode>>& program) {
+    collectFunctions(program);
+    SymbolId maxName = SYM_PRINT;
+    for (const auto& stmt : program) {
+        findMaxName(stmt.get(), maxName);
+    }
+    if (maxName >= variables.size()) {
+        variables.resize(maxName + 1);
+    }
+    if (profiler) {
+        profiler->start();
+    }
+    try {
+        executeBlock(program);
+    } catch (...) {
+        if (profiler) {
+            profiler->stop();
+        }
+        out.flush();  // output printed before the error still appears
+        throw;
+    }
+    if (profiler) {
+        profiler->stop();
+    }
+    out.flush();
+}
+
+const Value* Interpreter::lookup(const std::string& name) const {
+    SymbolId id = StringInterner::global().find(name);
+    if (id == NO_SYMBOL || id >= variables.size() || variables[id].isNone()) {
+        return nullptr;
+    }
+    return &variables[id];
+}
+
+// variables is sized by run(), this only guards against a name it missed
+Value& Interpreter::slot(SymbolId name) {
+    if (name >= variables.size()) {
+        variables.resize(name + 1);
+    }
+    return variables[name];
+}
+
+void Interpreter::executeBlock(const std::vector<std::unique_ptr<ASTNode>>& body) {
+    for (const auto& stmt : body) {
+        execute(stmt.get());
+        if (returning) {
+            return;
+        }
+    }
+}
+
+void Interpreter::execute(const ASTNode* stmt) {
+    try {
+        if (profiler) {
+            // a definition's line counts the calls, not the definition itself
+            if (dynamic_cast<const FunctionDefNode*>(stmt)) {
+                return;
+            }
+            ProfileScope scope(*profiler, stmt);
+            executeStatement(stmt);
+        } else {
+            executeStatement(stmt);
+        }
+    } catch (const RuntimeError&) {
+        throw;
+    } catch (const std::runtime_error& e) {
+        // made-up statements leave it to the enclosing one
+        if (stmt->line == 0) {
+            throw;
+        }
+        throw RuntimeError(e.what(), stmt->line);
+    }
+}
+
+void Interpreter::executeStatement(const ASTNode* stmt) {
+    if (auto decl = dynamic_cast<const VarDeclarationNode*>(stmt)) {
+        // evaluate first: slot() may grow the vector
+        Value value = decl->initializer
+            ? evaluate(decl->initializer.get())
+            : Value::defaultFor(decl->type);
+        slot(decl->name) = value;
+        return;
+    }
+    
+    if (auto assign = dynamic_cast<const AssignmentNode*>(stmt)) {
+        Value value = evaluate(assign->value.get());
+        Value& target = slot(assign->name);
+        if (target.isNone()) {
+            throw std::runtime_error("Присваивание необъявленной переменной " +
+                                     symbolName(assign->name));
+        }
+        target = value;
+        return;
+    }
+    
+    if (auto ifNode = dynamic_cast<const IfNode*>(stmt)) {
+        if (evaluate(ifNode->condition.get()).isTruthy()) {
+            executeBlock(ifNode->thenBody);
+        } else {
+            executeBlock(ifNode->elseBody);
+        }
+        return;
+    }
+    
+    if (auto whileNode = dynamic_cast<const WhileNode*>(stmt)) {
+        while (evaluate(whileNode->condition.get()).isTruthy()) {
+            if (profiler) {
+                profiler->iteration(whileNode);
+            }
+            executeBlock(whileNode->body);
+            if (returning) {
+                return;
+            }
+        }
+        return;
+    }
+    
+    if (auto block = dynamic_cast<const BlockNode*>(stmt)) {
+        executeBlock(block->statements);
+        return;
+    }
+    
+    if (auto ret = dynamic_cast<const ReturnNode*>(stmt)) {
+        returnValue = ret->value ? evaluate(ret->value.get()) : Value();
+        returning = true;
+        return;
+    }
+    
+    // collected by run()
+    if (dynamic_cast<const FunctionDefNode*>(stmt)) {
+        return;
+    }
+    
+    // expression statement, e.g. print("...");
+    evaluate(stmt);
+}
+
+Value Interpreter::evaluate(const ASTNode* expr) {
+    if (auto number = dynamic_cast<const NumberNode*>(expr)) {
+        return constants.number(number);
+    }
+    
+    if (auto str = dynamic_cast<const StringNode*>(expr)) {
+        return constants.string(str);
+    }
+    
+    if (auto ident = dynamic_cast<const IdentifierNode*>(expr)) {
+        // the parser keeps true/false as identifiers
+        if (ident->name == SYM_TRUE) return Value::makeBool(true);
+        if (ident->name == SYM_FALSE) return Value::makeBool(false);
+        
+        const Value& value = slot(ident->name);
+        if (value.isNone()) {
+            throw std::runtime_error("Необъявленная переменная " + symbolName(ident->name));
+        }
+        return value;
+    }
+    
+    if (auto binary = dynamic_cast<const BinaryOpNode*>(expr)) {
+        Value left = evaluate(binary->left.get());
+        Value right = evaluate(binary->right.get());
+        return applyBinaryOp(binary->op, left, right);
+    }
+    
+    if (auto conversion = dynamic_cast<const IntToFloatNode*>(expr)) {
+        return Value::makeFloat(evaluate(conversion->operand.get()).asFloat());
+    }
+    
+    if (auto call = dynamic_cast<const FunctionCallNode*>(expr)) {
+        return callFunction(call);
+    }
+    
+    throw std::runtime_error("Невозможно вычислить узел " + expr->toString());
+}
+
+Value Interpreter::callFunction(const FunctionCallNode* call) {
+    if (call->name == SYM_PRINT) {
+        for (size_t i = 0; i < call->arguments.size(); ++i) {
+            if (i > 0) out.put(' ');
+            evaluate(call->arguments[i].get()).writeTo(out);
+        }
+        out.put('\n');
+        return Value();
+    }
+    
+    if (call->name >= functions.size() || !functions[call->name].definition) {
+        throw std::runtime_error("Неизвестная функция " + symbolName(call->name));
+    }
+    const Function& function = functions[call->name];
+    const FunctionDefNode* definition = function.definition;
+    if (call->arguments.size() != definition->parameters.size()) {
+        throw std::runtime_error("Неверное число аргументов функции " + symbolName(call->name));
+    }
+    if (callDepth >= MAX_CALL_DEPTH) {
+        throw std::runtime_error("Слишком глубокая рекурсия (больше " +
+                                 std::to_string(MAX_CALL_DEPTH) + " вызовов)");
+    }
+    
+    // arguments are evaluated in the caller's scope
+    std::vector<Value> arguments;
+    arguments.reserve(call->arguments.size());
+    for (const auto& arg : call->arguments) {
+        arguments.push_back(evaluate(arg.get()));
+    }
+    
+    // the callee sees its own names only: their current values (the caller's
+    // variables, or an outer activation of a recursive function) are set
+    // aside and come back when it returns
+    std::vector<Value> saved;
+    saved.reserve(function.locals.size());
+    for (SymbolId name : function.locals) {
+        saved.push_back(std::move(slot(name)));
+    }
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        slot(definition->parameters[i].name) = std::move(arguments[i]);
+    }
+    
+    ++callDepth;
+    if (profiler) {
+        ProfileScope scope(*profiler, definition);
+        executeBlock(definition->body);
+    } else {
+        executeBlock(definition->body);
+    }
+    --callDepth;
+    
+    bool returned = returning;
+    returning = false;
+    Value result = std::move(returnValue);
+    for (size_t i = 0; i < saved.size(); ++i) {
+        slot(function.locals[i]) = std::move(saved[i]);
+    }
+    if (!returned && definition->returnType != "void") {
+        throw std::runtime_error("Функция " + symbolName(call->name) + " завершилась без return");
+    }
+    return result;
+}
@@ -0,0 +1,69 @@
+#ifndef INTERPRETER_HPP
+#define INTERPRETER_HPP
+
+#include "../parser/parser.hpp"
+#include "value.hpp"
+#include "constant_pool.hpp"
+#include "output_buffer.hpp"
+#include "profiler.hpp"
+#include <stdexcept>
+
+// runtime error raised while executing the statement at line
+class RuntimeError : public std::runtime_error {
+private:
+    int sourceLine;
+    
+public:
+    RuntimeError(const std::string& message, int line)
+        : std::runtime_error(message), sourceLine(line) {}
+    int line() const { return sourceLine; }
+};
+
+// Tree-walking interpreter over the AST produced by Parser
+class Interpreter {
+private:
+    struct Function {
+        const FunctionDefNode* definition;  // nullptr: no function of that name
+        std::vector<SymbolId> locals;       // parameters and names declared in the body
+        
+        Function() : definition(nullptr) {}
+    };
+    
+    // indexed by SymbolId; NONE marks a variable that is not declared
+    std::vector<Value> variables;
+    std::vector<Function> functions;  // indexed by SymbolId too
+    ConstantPool constants;
+    OutputBuffer out;  // print() output, flushed when run() returns or throws
+    Profiler* profiler;  // nullptr unless profiling
+    bool returning;      // a return is unwinding to its call
+    Value returnValue;
+    size_t callDepth;
+
+    Value& slot(SymbolId name);
+    void collectFunctions(const std::vector<std::unique_ptr<ASTNode>>& program);
+
+    void executeBlock(const std::vector<std::unique_ptr<ASTNode>>& body);
+    void execute(const ASTNode* stmt);
+    void executeStatement(const ASTNode* stmt);
+    Value evaluate(const ASTNode* expr);
+    Value callFunction(const FunctionCallNode* call);
+
+public:
+    // calls deeper than this are reported as a runtime error instead of
+    // overflowing the native stack
+    static const size_t MAX_CALL_DEPTH = 1000;
+    
+    Interpreter(std::ostream& output = std::cout);
+
+    // statements run from now on are reported to profiler (nullptr stops it)
+    void setProfiler(Profiler* p) { profiler = p; }
+    
+    // runs the program; errors are reported as RuntimeError with the line
+    // of the innermost statement that has one
+    void run(const std::vector<std::unique_ptr<ASTNode>>& program);
+
+    // value of a global after run(), nullptr if it was never declared
+    const Value* lookup(const std::string& name) const;
+};
+
+#endif
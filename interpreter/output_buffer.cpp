@@ -0,0 +1,46 @@
+#include "output_buffer.hpp"
+#include <cstdio>
+#include <cstring>
+
+OutputBuffer::OutputBuffer(std::ostream& stream, size_t capacity)
+    : out(stream), buffer(capacity), used(0) {}
+
+void OutputBuffer::write(const char* data, size_t size) {
+    if (size > buffer.size() - used) {
+        flush();
+        if (size >= buffer.size()) {
+            out.write(data, size);  // larger than the buffer: no point copying
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, data, size);
+    used += size;
+}
+
+void OutputBuffer::writeInt(int32_t value) {
+    char digits[12];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) : value;
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        *--p = '-';
+    }
+    write(p, end - p);
+}
+
+void OutputBuffer::writeFloat(double value) {
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%g", value);
+    write(text, length);
+}
+
+void OutputBuffer::flush() {
+    if (used > 0) {
+        out.write(buffer.data(), used);
+        used = 0;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef OUTPUT_BUFFER_HPP
+#define OUTPUT_BUFFER_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Collects program output and hands it to the stream in large blocks,
+// instead of one formatted stream insertion per printed value.
+class OutputBuffer {
+private:
+    std::ostream& out;
+    std::vector<char> buffer;
+    size_t used;
+    
+public:
+    explicit OutputBuffer(std::ostream& stream, size_t capacity = 1 << 16);
+    ~OutputBuffer() { flush(); }
+    
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+    
+    void write(const char* data, size_t size);
+    void put(char c) {
+        if (used == buffer.size()) {
+            flush();
+        }
+        buffer[used++] = c;
+    }
+    void writeInt(int32_t value);
+    void writeFloat(double value);  // same text as std::ostream's default format
+    void flush();
+};
+
+#endif
@@ -0,0 +1,267 @@
+#include "profiler.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <sys/time.h>
+
+const size_t Profiler::MAX_STACK;
+const size_t Profiler::SAMPLE_CAPACITY;
+const size_t Profiler::FRAME_CAPACITY;
+
+// the profiler the SIGPROF handler records into
+static Profiler* volatile sampling = nullptr;
+
+Profiler::Profiler(ProfileMode mode, int intervalUs)
+    : profileMode(mode), interval(intervalUs > 0 ? intervalUs : 1000), running(false),
+      depth(0), samples(0), framesUsed(0), dropped(0) {
+    if (profileMode == ProfileMode::SAMPLE) {
+        // left uninitialized: pages are only touched by the samples taken
+        frames.reset(new const ASTNode*[FRAME_CAPACITY]);
+        sampleStart.reset(new uint32_t[SAMPLE_CAPACITY + 1]);
+        sampleStart[0] = 0;
+    }
+}
+
+Profiler::~Profiler() {
+    stop();
+}
+
+void Profiler::start() {
+    if (profileMode != ProfileMode::SAMPLE || running) {
+        return;
+    }
+    if (sampling) {
+        throw std::runtime_error("Профилировщик уже запущен");
+    }
+    sampling = this;
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, &previousAction);
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = interval / 1000000;
+    timer.it_interval.tv_usec = interval % 1000000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    running = true;
+}
+
+void Profiler::stop() {
+    if (!running) {
+        return;
+    }
+    struct itimerval timer;
+    std::memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    sigaction(SIGPROF, &previousAction, nullptr);
+    sampling = nullptr;
+    running = false;
+    resolveSamples();
+}
+
+void Profiler::onSignal(int) {
+    int savedErrno = errno;
+    Profiler* profiler = sampling;
+    if (profiler) {
+        profiler->takeSample();
+    }
+    errno = savedErrno;
+}
+
+// async-signal context: no allocation, no locks
+void Profiler::takeSample() {
+    size_t count = depth < MAX_STACK ? depth : MAX_STACK;
+    if (count == 0) {
+        return;  // between statements of the top level, nothing to attribute
+    }
+    std::atomic_signal_fence(std::memory_order_acquire);
+    if (samples >= SAMPLE_CAPACITY || framesUsed + count > FRAME_CAPACITY) {
+        dropped = dropped + 1;
+        return;
+    }
+    size_t used = framesUsed;
+    for (size_t i = 0; i < count; ++i) {
+        frames[used + i] = stack[i];
+    }
+    framesUsed = used + count;
+    sampleStart[samples + 1] = static_cast<uint32_t>(framesUsed);
+    samples = samples + 1;
+}
+
+static std::string frameName(const ASTNode* node) {
+    std::string name;
+    if (dynamic_cast<const WhileNode*>(node)) {
+        name = "while";
+    } else if (dynamic_cast<const IfNode*>(node)) {
+        name = "if";
+    } else if (dynamic_cast<const BlockNode*>(node)) {
+        name = "{}";
+    } else if (auto decl = dynamic_cast<const VarDeclarationNode*>(node)) {
+        name = decl->type + " " + symbolName(decl->name);
+    } else if (auto assign = dynamic_cast<const AssignmentNode*>(node)) {
+        name = symbolName(assign->name) + "=";
+    } else if (auto call = dynamic_cast<const FunctionCallNode*>(node)) {
+        name = symbolName(call->name);
+    } else if (auto function = dynamic_cast<const FunctionDefNode*>(node)) {
+        name = symbolName(function->name) + "()";
+    } else if (dynamic_cast<const ReturnNode*>(node)) {
+        name = "return";
+    } else {
+        name = "expr";
+    }
+    // ';' separates frames in the folded format
+    for (auto& c : name) {
+        if (c == ';') c = ',';
+    }
+    return name + ":" + std::to_string(node->line);
+}
+
+void Profiler::resolveSamples() {
+    std::map<const ASTNode*, uint32_t> ids;
+    for (size_t i = resolvedFrames.size(); i < framesUsed; ++i) {
+        auto it = ids.find(frames[i]);
+        if (it == ids.end()) {
+            FrameInfo info;
+            info.name = frameName(frames[i]);
+            info.line = frames[i]->line;
+            it = ids.insert(std::make_pair(frames[i], static_cast<uint32_t>(frameInfo.size()))).first;
+            frameInfo.push_back(info);
+        }
+        resolvedFrames.push_back(it->second);
+    }
+}
+
+void Profiler::writeFolded(std::ostream& out) const {
+    std::map<std::string, uint64_t> stacks;
+    for (size_t k = 0; k < samples; ++k) {
+        std::string key = "program";
+        for (size_t i = sampleStart[k]; i < sampleStart[k + 1]; ++i) {
+            key += ';';
+            key += frameInfo[resolvedFrames[i]].name;
+        }
+        stacks[key]++;
+    }
+    for (const auto& entry : stacks) {
+        out << entry.first << " " << entry.second << "\n";
+    }
+}
+
+std::vector<Profiler::LineProfile> Profiler::aggregate() const {
+    std::vector<LineProfile> result = lines;
+    std::vector<size_t> seenIn(result.size(), 0);  // last sample that counted the line, + 1
+    for (size_t k = 0; k < samples; ++k) {
+        for (size_t i = sampleStart[k]; i < sampleStart[k + 1]; ++i) {
+            int frameLine = frameInfo[resolvedFrames[i]].line;
+            size_t line = frameLine > 0 ? static_cast<size_t>(frameLine) : 0;
+            if (line >= result.size()) {
+                result.resize(line + 1);
+                seenIn.resize(line + 1, 0);
+            }
+            // a line is counted once per sample however often it recurs
+            if (seenIn[line] != k + 1) {
+                seenIn[line] = k + 1;
+                result[line].totalSamples++;
+            }
+            if (i + 1 == sampleStart[k + 1]) {
+                result[line].selfSamples++;
+            }
+        }
+    }
+    return result;
+}
+
+static void writeCell(std::ostream& out, int width, uint64_t value) {
+    char cell[32];
+    if (value == 0) {
+        std::snprintf(cell, sizeof(cell), "%*s", width, "");
+    } else {
+        std::snprintf(cell, sizeof(cell), "%*llu", width, static_cast<unsigned long long>(value));
+    }
+    out << cell;
+}
+
+static void writePercent(std::ostream& out, uint64_t part, uint64_t whole) {
+    char cell[32];
+    if (part == 0 || whole == 0) {
+        std::snprintf(cell, sizeof(cell), "%8s", "");
+    } else {
+        std::snprintf(cell, sizeof(cell), "%8.1f", 100.0 * part / whole);
+    }
+    out << cell;
+}
+
+void Profiler::writeAnnotatedSource(const std::string& source, std::ostream& out) const {
+    std::vector<LineProfile> profile = aggregate();
+    bool counting = profileMode == ProfileMode::COUNT;
+
+    if (counting) {
+        out << "--- ПРОФИЛЬ: точный подсчёт ---\n";
+        out << " строка  выполнений    итераций | исходный код\n";
+    } else {
+        out << "--- ПРОФИЛЬ: " << samples << " выборок по " << interval << " мкс";
+        if (dropped > 0) {
+            out << ", не поместилось " << dropped;
+        }
+        out << " ---\n";
+        out << " строка   своё %  всего % | исходный код\n";
+    }
+
+    size_t begin = 0;
+    int lineNumber = 1;
+    while (begin <= source.size()) {
+        size_t end = source.find('\n', begin);
+        if (end == std::string::npos) {
+            end = source.size();
+            if (begin == end) {
+                break;  // nothing after the last newline
+            }
+        }
+        LineProfile row;
+        if (static_cast<size_t>(lineNumber) < profile.size()) {
+            row = profile[lineNumber];
+        }
+        char number[16];
+        std::snprintf(number, sizeof(number), "%7d", lineNumber);
+        out << number;
+        if (counting) {
+            writeCell(out, 12, row.executions);
+            writeCell(out, 12, row.iterations);
+        } else {
+            out << " ";
+            writePercent(out, row.selfSamples, samples);
+            out << " ";
+            writePercent(out, row.totalSamples, samples);
+        }
+        out << " | " << source.substr(begin, end - begin) << "\n";
+        begin = end + 1;
+        lineNumber++;
+    }
+
+    // statements the optimizers made up without a source line
+    if (!profile.empty() && (profile[0].executions > 0 || profile[0].selfSamples > 0)) {
+        out << "без строки:";
+        if (counting) {
+            out << " выполнений " << profile[0].executions << "\n";
+        } else {
+            out << " своё " << profile[0].selfSamples << " выборок\n";
+        }
+    }
+}
+
+bool parseProfileMode(const std::string& text, ProfileMode& mode) {
+    if (text == "sample") {
+        mode = ProfileMode::SAMPLE;
+        return true;
+    }
+    if (text == "count") {
+        mode = ProfileMode::COUNT;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,134 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "../parser/parser.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+
+enum class ProfileMode {
+    SAMPLE,  // stack of the running statements on every SIGPROF tick
+    COUNT,   // exact statement executions and loop iterations, no timing
+};
+
+// Execution profiler of the Interpreter. The interpreter reports every
+// statement it enters and leaves; the profiler keeps them as a stack of AST
+// nodes, which the SIGPROF handler copies into a preallocated buffer (it may
+// not allocate). Results are attributed to source lines through the node
+// positions and written as folded stacks (flamegraph.pl, speedscope) or as
+// the source annotated with per-line numbers.
+class Profiler {
+public:
+    static const size_t MAX_STACK = 1024;       // deeper frames are not recorded
+    static const size_t SAMPLE_CAPACITY = 1 << 16;
+    static const size_t FRAME_CAPACITY = 1 << 22;
+
+    explicit Profiler(ProfileMode mode, int intervalUs = 1000);
+    ~Profiler();
+
+    ProfileMode mode() const { return profileMode; }
+    int intervalUs() const { return interval; }
+
+    // SIGPROF timer (ITIMER_PROF, process CPU time) in SAMPLE mode; one
+    // profiler may sample at a time. stop() resolves the sampled nodes to
+    // names and lines, so the AST may be freed afterwards.
+    void start();
+    void stop();
+
+    void enter(const ASTNode* stmt) {
+        if (depth < MAX_STACK) {
+            stack[depth] = stmt;
+        }
+        // the frame must be in place before the handler can see it
+        std::atomic_signal_fence(std::memory_order_release);
+        depth = depth + 1;
+        if (profileMode == ProfileMode::COUNT) {
+            lineAt(stmt->line).executions++;
+        }
+    }
+
+    void leave() {
+        depth = depth - 1;
+    }
+
+    void iteration(const WhileNode* loop) {
+        if (profileMode == ProfileMode::COUNT) {
+            lineAt(loop->line).iterations++;
+        }
+    }
+
+    size_t sampleCount() const { return samples; }
+    size_t droppedSamples() const { return dropped; }
+
+    // "program;while:5;x=:6 42" per distinct stack, counts in samples
+    void writeFolded(std::ostream& out) const;
+    // every source line with its executions/iterations (COUNT) or the share
+    // of samples spent on it and below it (SAMPLE)
+    void writeAnnotatedSource(const std::string& source, std::ostream& out) const;
+
+private:
+    struct LineProfile {
+        uint64_t executions;
+        uint64_t iterations;
+        uint64_t selfSamples;   // line on top of the stack
+        uint64_t totalSamples;  // line anywhere on the stack
+
+        LineProfile() : executions(0), iterations(0), selfSamples(0), totalSamples(0) {}
+    };
+
+    ProfileMode profileMode;
+    int interval;
+    bool running;
+
+    const ASTNode* stack[MAX_STACK];
+    volatile size_t depth;
+
+    // samples stored back to back: frames [sampleStart[k], sampleStart[k + 1])
+    std::unique_ptr<const ASTNode*[]> frames;
+    std::unique_ptr<uint32_t[]> sampleStart;
+    volatile size_t samples;
+    volatile size_t framesUsed;
+    volatile size_t dropped;
+
+    std::vector<LineProfile> lines;  // by source line, COUNT mode
+
+    // sampled frames after stop(): indices into frameInfo
+    struct FrameInfo {
+        std::string name;  // "while:5"
+        int line;
+    };
+    std::vector<FrameInfo> frameInfo;
+    std::vector<uint32_t> resolvedFrames;
+
+    struct sigaction previousAction;
+
+    LineProfile& lineAt(int line) {
+        size_t index = line > 0 ? static_cast<size_t>(line) : 0;
+        if (index >= lines.size()) {
+            lines.resize(index + 1);
+        }
+        return lines[index];
+    }
+
+    static void onSignal(int signal);
+    void takeSample();
+    void resolveSamples();
+    std::vector<LineProfile> aggregate() const;
+};
+
+// enter()/leave() pair that also unwinds on runtime errors
+class ProfileScope {
+private:
+    Profiler& profiler;
+
+public:
+    ProfileScope(Profiler& p, const ASTNode* stmt) : profiler(p) {
+        profiler.enter(stmt);
+    }
+    ~ProfileScope() { profiler.leave(); }
+};
+
+bool parseProfileMode(const std::string& text, ProfileMode& mode);
+
+#endif
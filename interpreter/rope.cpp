@@ -0,0 +1,139 @@
+#include "rope.hpp"
+#include "output_buffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+const uint16_t RopeString::MAX_DEPTH;
+const size_t RopeString::SHORT_LENGTH;
+
+// header and characters in one allocation
+RopeString* RopeString::allocateFlat(size_t length, char*& chars) {
+    void* memory = ::operator new(sizeof(RopeString) + length);
+    RopeString* node = new (memory) RopeString();
+    chars = reinterpret_cast<char*>(node + 1);
+    node->chars = chars;
+    node->length = length;
+    return node;
+}
+
+RopeString* RopeString::copy(const char* data, size_t length) {
+    char* chars;
+    RopeString* node = allocateFlat(length, chars);
+    std::memcpy(chars, data, length);
+    return node;
+}
+
+RopeString* RopeString::borrow(const std::string& text) {
+    char* unused;
+    RopeString* node = allocateFlat(0, unused);
+    node->chars = text.data();
+    node->length = text.size();
+    return node;
+}
+
+RopeString* RopeString::concat(RopeString* left, RopeString* right) {
+    if (left->length == 0) {
+        left->release();
+        return right;
+    }
+    if (right->length == 0) {
+        right->release();
+        return left;
+    }
+    
+    // short pieces: one flat copy is cheaper than a node to walk later
+    if (left->length + right->length <= SHORT_LENGTH) {
+        char* chars;
+        RopeString* node = allocateFlat(left->length + right->length, chars);
+        left->copyTo(chars);
+        right->copyTo(chars + left->length);
+        left->release();
+        right->release();
+        return node;
+    }
+    // appending a short piece to "... + short": merge it into that last leaf
+    if (left->depth > 0 && left->right->depth == 0 &&
+        left->right->length + right->length <= SHORT_LENGTH) {
+        RopeString* prefix = left->left;
+        RopeString* tail = left->right;
+        prefix->retain();
+        tail->retain();
+        left->release();
+        return concat(prefix, concat(tail, right));
+    }
+    
+    RopeString* node = new (::operator new(sizeof(RopeString))) RopeString();
+    node->depth = static_cast<uint16_t>(std::max(left->depth, right->depth) + 1);
+    node->length = left->length + right->length;
+    node->left = left;
+    node->right = right;
+    if (node->depth > MAX_DEPTH) {
+        node->flatten();
+    }
+    return node;
+}
+
+void RopeString::release() {
+    if (--refs > 0) {
+        return;
+    }
+    if (depth > 0) {
+        left->release();   // recursion is bounded by MAX_DEPTH
+        right->release();
+    }
+    if (ownsChars) {
+        delete[] chars;
+    }
+    this->~RopeString();
+    ::operator delete(this);
+}
+
+void RopeString::copyTo(char* out) const {
+    if (depth == 0) {
+        std::memcpy(out, chars, length);
+        return;
+    }
+    left->copyTo(out);
+    right->copyTo(out + left->length);
+}
+
+// Turns a concatenation into a flat node in place; other references to
+// this node see the same characters, only faster.
+void RopeString::flatten() {
+    if (depth == 0) {
+        return;
+    }
+    char* buffer = new char[length];
+    copyTo(buffer);
+    left->release();
+    right->release();
+    left = right = nullptr;
+    depth = 0;
+    chars = buffer;
+    ownsChars = true;
+}
+
+int RopeString::compare(RopeString* other) {
+    flatten();
+    other->flatten();
+    int result = std::memcmp(chars, other->chars, std::min(length, other->length));
+    if (result != 0) {
+        return result;
+    }
+    return length < other->length ? -1 : (length > other->length ? 1 : 0);
+}
+
+std::string RopeString::str() {
+    flatten();
+    return std::string(chars, length);
+}
+
+void RopeString::writeTo(OutputBuffer& out) const {
+    if (depth == 0) {
+        out.write(chars, length);
+        return;
+    }
+    left->writeTo(out);
+    right->writeTo(out);
+}
@@ -0,0 +1,59 @@
+#ifndef ROPE_HPP
+#define ROPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class OutputBuffer;
+
+// Immutable reference-counted string for runtime values. A node is either
+// flat (contiguous characters) or the concatenation of two nodes, so `a + b`
+// costs O(1); the characters are gathered only when something needs them
+// contiguously (comparison, std::string conversion), and printing walks the
+// pieces directly. Reference counts are not atomic: values stay on the
+// thread of the interpreter that created them.
+class RopeString {
+private:
+    uint32_t refs;
+    uint16_t depth;       // 0 for flat nodes
+    bool ownsChars;       // chars is a separate allocation to delete
+    size_t length;
+    const char* chars;    // flat nodes only
+    RopeString* left;     // concatenations only
+    RopeString* right;
+    
+    RopeString() : refs(1), depth(0), ownsChars(false), length(0),
+                   chars(nullptr), left(nullptr), right(nullptr) {}
+    ~RopeString() = default;
+    
+    static RopeString* allocateFlat(size_t length, char*& chars);
+    void flatten();
+    void copyTo(char* out) const;
+    
+public:
+    // concatenations deeper than this are flattened, which bounds recursion
+    static const uint16_t MAX_DEPTH = 48;
+    // pieces up to this size are copied together instead of linked
+    static const size_t SHORT_LENGTH = 64;
+    
+    RopeString(const RopeString&) = delete;
+    RopeString& operator=(const RopeString&) = delete;
+    
+    // new strings start with one reference owned by the caller
+    static RopeString* copy(const char* data, size_t length);
+    // characters are not copied; text must outlive every reference
+    static RopeString* borrow(const std::string& text);
+    // takes over the caller's references to left and right
+    static RopeString* concat(RopeString* left, RopeString* right);
+    
+    void retain() { ++refs; }
+    void release();
+    
+    size_t size() const { return length; }
+    int compare(RopeString* other);
+    std::string str();
+    void writeTo(OutputBuffer& out) const;
+};
+
+#endif
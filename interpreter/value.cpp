@@ -0,0 +1,158 @@
+#include "value.hpp"
+#include "output_buffer.hpp"
+#include "../parser/parser.hpp"
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+Value Value::makeFloat(double v) {
+    uint64_t b;
+    if (v != v) {
+        b = 0x7FF8000000000000ull;  // canonical NaN, outside the boxed range
+    } else {
+        std::memcpy(&b, &v, sizeof(b));
+    }
+    return Value(b);
+}
+
+Value Value::makeString(const std::string& v) {
+    return fromRope(RopeString::copy(v.data(), v.size()));
+}
+
+Value Value::defaultFor(const std::string& typeName) {
+    if (typeName == "int") return makeInt(0);
+    if (typeName == "float") return makeFloat(0.0);
+    if (typeName == "string") return makeString("");
+    if (typeName == "bool") return makeBool(false);
+    return Value();
+}
+
+bool Value::isTruthy() const {
+    switch (type()) {
+        case ValueType::BOOL:   return boolValue();
+        case ValueType::INT:    return intValue() != 0;
+        case ValueType::FLOAT:  return floatValue() != 0.0;
+        case ValueType::STRING: return rope()->size() != 0;
+        case ValueType::NONE:   return false;
+    }
+    return false;
+}
+
+bool Value::identical(const Value& other) const {
+    if (isString() && other.isString()) {
+        return rope() == other.rope() || rope()->compare(other.rope()) == 0;
+    }
+    return bits == other.bits;
+}
+
+std::string Value::toString() const {
+    switch (type()) {
+        case ValueType::INT:    return std::to_string(intValue());
+        case ValueType::FLOAT: {
+            std::ostringstream out;
+            out << floatValue();
+            return out.str();
+        }
+        case ValueType::STRING: return rope()->str();
+        case ValueType::BOOL:   return boolValue() ? "true" : "false";
+        case ValueType::NONE:   return "none";
+    }
+    return "";
+}
+
+void Value::writeTo(OutputBuffer& out) const {
+    switch (type()) {
+        case ValueType::INT:    out.writeInt(intValue()); break;
+        case ValueType::FLOAT:  out.writeFloat(floatValue()); break;
+        case ValueType::STRING: rope()->writeTo(out); break;
+        case ValueType::BOOL:   boolValue() ? out.write("true", 4) : out.write("false", 5); break;
+        case ValueType::NONE:   out.write("none", 4); break;
+    }
+}
+
+Value parseNumberLiteral(const std::string& literal) {
+    if (literal.find('.') != std::string::npos) {
+        return Value::makeFloat(floatLiteralValue(literal));
+    }
+    return Value::makeInt(intLiteralValue(literal));
+}
+
+static int32_t wrapInt(uint32_t v) {
+    return static_cast<int32_t>(v);
+}
+
+static Value compare(const std::string& op, int cmp) {
+    if (op == "==") return Value::makeBool(cmp == 0);
+    if (op == "!=") return Value::makeBool(cmp != 0);
+    if (op == "<")  return Value::makeBool(cmp < 0);
+    if (op == ">")  return Value::makeBool(cmp > 0);
+    if (op == "<=") return Value::makeBool(cmp <= 0);
+    if (op == ">=") return Value::makeBool(cmp >= 0);
+    throw std::runtime_error("Неизвестный оператор сравнения " + op);
+}
+
+// compared directly rather than through a three-way result, which would make
+// NaN equal to everything; with NaN only != holds
+static Value compareFloats(const std::string& op, double a, double b) {
+    if (op == "==") return Value::makeBool(a == b);
+    if (op == "!=") return Value::makeBool(a != b);
+    if (op == "<")  return Value::makeBool(a < b);
+    if (op == ">")  return Value::makeBool(a > b);
+    if (op == "<=") return Value::makeBool(a <= b);
+    if (op == ">=") return Value::makeBool(a >= b);
+    throw std::runtime_error("Неизвестный оператор сравнения " + op);
+}
+
+Value applyBinaryOp(const std::string& op, const Value& l, const Value& r) {
+    ValueType lt = l.type();
+    ValueType rt = r.type();
+    if (lt == ValueType::INT && rt == ValueType::INT) {
+        uint32_t a = static_cast<uint32_t>(l.intValue());
+        uint32_t b = static_cast<uint32_t>(r.intValue());
+        if (op == "+") return Value::makeInt(wrapInt(a + b));
+        if (op == "-") return Value::makeInt(wrapInt(a - b));
+        if (op == "*") return Value::makeInt(wrapInt(a * b));
+        if (op == "/") {
+            if (r.intValue() == 0) {
+                throw std::runtime_error("Деление на ноль");
+            }
+            // INT_MIN / -1 overflows in C++, wrap it instead
+            if (r.intValue() == -1) return Value::makeInt(wrapInt(0u - a));
+            return Value::makeInt(l.intValue() / r.intValue());
+        }
+        int cmp = l.intValue() < r.intValue() ? -1 : (l.intValue() > r.intValue() ? 1 : 0);
+        return compare(op, cmp);
+    }
+
+    if (l.isNumeric() && r.isNumeric()) {
+        double a = l.asFloat();
+        double b = r.asFloat();
+        if (op == "+") return Value::makeFloat(a + b);
+        if (op == "-") return Value::makeFloat(a - b);
+        if (op == "*") return Value::makeFloat(a * b);
+        if (op == "/") {
+            if (b == 0.0) {
+                throw std::runtime_error("Деление на ноль");
+            }
+            return Value::makeFloat(a / b);
+        }
+        return compareFloats(op, a, b);
+    }
+
+    if (lt == ValueType::STRING && rt == ValueType::STRING) {
+        if (op == "+") {
+            l.stringValue()->retain();
+            r.stringValue()->retain();
+            return Value::fromRope(RopeString::concat(l.stringValue(), r.stringValue()));
+        }
+        return compare(op, l.stringValue()->compare(r.stringValue()));
+    }
+
+    if (lt == ValueType::BOOL && rt == ValueType::BOOL &&
+        (op == "==" || op == "!=")) {
+        return compare(op, l.boolValue() == r.boolValue() ? 0 : 1);
+    }
+
+    throw std::runtime_error("Недопустимые операнды для оператора " + op +
+                             ": " + l.toString() + ", " + r.toString());
+}
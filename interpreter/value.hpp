@@ -0,0 +1,116 @@
+#ifndef VALUE_HPP
+#define VALUE_HPP
+
+#include "rope.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// runtime types of the language values
+enum class ValueType {
+    NONE,
+    INT,     // 32-bit, wraps on overflow like C int
+    FLOAT,
+    STRING,
+    BOOL,
+};
+
+// 8-byte NaN-boxed value. A double is stored as its own bits; every other
+// type sits in the 48-bit payload of a negative quiet NaN with a nonzero tag
+// in bits 48-50. Arithmetic NaNs are canonicalized to a positive quiet NaN,
+// so they never collide with a boxed value. Strings point to a RopeString
+// and hold one reference to it.
+class Value {
+private:
+    uint64_t bits;
+    
+    static const uint64_t BOX_MASK = 0xFFF8000000000000ull;
+    static const uint64_t PAYLOAD_MASK = 0x0000FFFFFFFFFFFFull;
+    static const uint64_t TAG_NONE = 1;
+    static const uint64_t TAG_INT = 2;
+    static const uint64_t TAG_BOOL = 3;
+    static const uint64_t TAG_STRING = 4;
+    
+    static uint64_t box(uint64_t tag, uint64_t payload) {
+        return BOX_MASK | (tag << 48) | payload;
+    }
+    uint64_t tag() const {
+        return (bits & BOX_MASK) == BOX_MASK ? (bits >> 48) & 7 : 0;
+    }
+    bool isString() const { return (bits >> 48) == (BOX_MASK | (TAG_STRING << 48)) >> 48; }
+    RopeString* rope() const { return reinterpret_cast<RopeString*>(bits & PAYLOAD_MASK); }
+    
+    explicit Value(uint64_t b) : bits(b) {}
+    
+public:
+    Value() : bits(box(TAG_NONE, 0)) {}
+    Value(const Value& other) : bits(other.bits) {
+        if (isString()) rope()->retain();
+    }
+    Value(Value&& other) noexcept : bits(other.bits) {
+        other.bits = box(TAG_NONE, 0);
+    }
+    Value& operator=(const Value& other) {
+        Value copy(other);
+        std::swap(bits, copy.bits);
+        return *this;
+    }
+    Value& operator=(Value&& other) noexcept {
+        std::swap(bits, other.bits);
+        return *this;
+    }
+    ~Value() {
+        if (isString()) rope()->release();
+    }
+    
+    static Value makeInt(int32_t v) { return Value(box(TAG_INT, static_cast<uint32_t>(v))); }
+    static Value makeFloat(double v);
+    static Value makeBool(bool v) { return Value(box(TAG_BOOL, v ? 1 : 0)); }
+    static Value makeString(const std::string& v);  // copies the characters
+    // takes over the caller's reference
+    static Value fromRope(RopeString* rope) {
+        return Value(box(TAG_STRING, reinterpret_cast<uintptr_t>(rope)));
+    }
+    
+    // default value for "int x;" style declarations
+    static Value defaultFor(const std::string& typeName);
+    
+    ValueType type() const {
+        switch (tag()) {
+            case 0:          return ValueType::FLOAT;
+            case TAG_INT:    return ValueType::INT;
+            case TAG_BOOL:   return ValueType::BOOL;
+            case TAG_STRING: return ValueType::STRING;
+            default:         return ValueType::NONE;
+        }
+    }
+    bool isNone() const { return tag() == TAG_NONE; }
+    
+    int32_t intValue() const { return static_cast<int32_t>(static_cast<uint32_t>(bits)); }
+    double floatValue() const {
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    bool boolValue() const { return (bits & 1) != 0; }
+    RopeString* stringValue() const { return rope(); }
+    
+    bool isNumeric() const { ValueType t = type(); return t == ValueType::INT || t == ValueType::FLOAT; }
+    double asFloat() const { return type() == ValueType::INT ? intValue() : floatValue(); }
+    bool isTruthy() const;
+    // same type and value; strings compare by content
+    bool identical(const Value& other) const;
+    
+    std::string toString() const;
+    void writeTo(OutputBuffer& out) const;
+};
+
+static_assert(sizeof(Value) == 8, "Value must stay one machine word");
+
+// "42" -> INT, "3.14" -> FLOAT
+Value parseNumberLiteral(const std::string& literal);
+
+// evaluates l op r; throws std::runtime_error on type errors and division by zero
+Value applyBinaryOp(const std::string& op, const Value& l, const Value& r);
+
+#endif
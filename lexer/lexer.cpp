@@ -1,9 +1,29 @@
 #include "lexer.hpp"
+#include "../util/utf8.hpp"
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
-Lexer::Lexer(const std::string& src)
-	: source(src), position(0), line(1), column(1){
+// ASCII-only classification: the <cctype> functions are undefined for
+// negative chars, and every byte of a UTF-8 sequence is negative
+static inline bool isDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+static inline bool isAlpha(char c) {
+    return static_cast<unsigned char>((c | 0x20) - 'a') < 26;
+}
+
+static inline bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool isNonAscii(char c) {
+    return static_cast<unsigned char>(c) >= 0x80;
+}
+
+Lexer::Lexer(const std::string& src, const LexerOptions& opts)
+	: source(src), options(opts), position(0), line(1), column(1){
 		if(!source.empty()){
 			currentChar = source[position];
 		}else{
@@ -13,13 +33,16 @@ Lexer::Lexer(const std::string& src)
 
 void Lexer::advance(){
 	position++;
-	column++;
 
 	if(position < source.length()){
 		currentChar = source[position];
 	}else{
 		currentChar = '\0';
 	}
+	// continuation bytes belong to the code point already counted
+	if(!isUtf8Continuation(currentChar)){
+		column++;
+	}
 }
 
 char Lexer::peek(){
@@ -30,19 +53,26 @@ char Lexer::peek(){
 }
 
 void Lexer::skipWhitespace(){
-	while(currentChar != '\0' && std::isspace(currentChar)){
+	while(currentChar != '\0' && isSpace(currentChar)){
 		if(currentChar == '\n'){
 			line++;
-			column = 1;
+			column = 0; // advance() moves onto column 1
 		}
 		advance();
 	}
 }
 
 void Lexer::skipComment(){
-	while(currentChar != '\0' && currentChar != '\n'){
-		advance();
+	size_t end = source.find('\n', position);
+	if(end == std::string::npos){
+		while(currentChar != '\0'){
+			advance();
+		}
+		return;
 	}
+	// jump straight to the newline, which resets the column anyway
+	position = end;
+	currentChar = '\n';
 	skipWhitespace();
 }
 
@@ -55,6 +85,51 @@ bool Lexer::isKeyword(const std::string& str){
 	return false;
 }
 
+bool Lexer::isIdentifierStart() {
+    if (isAlpha(currentChar) || currentChar == '_') {
+        return true;
+    }
+    if (!options.unicodeIdentifiers || !isNonAscii(currentChar)) {
+        return false;
+    }
+    uint32_t codePoint;
+    decodeUtf8(&source[position], source.length() - position, codePoint);
+    return isUnicodeIdentifierStart(codePoint);
+}
+
+bool Lexer::isIdentifierContinue() {
+    if (isAlpha(currentChar) || isDigit(currentChar) || currentChar == '_') {
+        return true;
+    }
+    if (!options.unicodeIdentifiers || !isNonAscii(currentChar)) {
+        return false;
+    }
+    uint32_t codePoint;
+    decodeUtf8(&source[position], source.length() - position, codePoint);
+    return isUnicodeIdentifierContinue(codePoint);
+}
+
+// Rejects malformed UTF-8 before any token is produced, reporting the
+// line and code-point column of the first bad byte.
+void Lexer::validateEncoding() {
+    size_t bad = findInvalidUtf8(source.data(), source.length());
+    if (bad == source.length()) {
+        return;
+    }
+    int badLine = 1;
+    int badColumn = 1;
+    for (size_t i = 0; i < bad; ++i) {
+        if (source[i] == '\n') {
+            badLine++;
+            badColumn = 1;
+        } else if (!isUtf8Continuation(source[i])) {
+            badColumn++;
+        }
+    }
+    throw std::runtime_error("Некорректная последовательность UTF-8 в строке " +
+                             std::to_string(badLine) + ", столбце " + std::to_string(badColumn));
+}
+
 bool Lexer::isOperator(char c) {
     return c == '+' || c == '-' || c == '*' || c == '/' || 
            c == '=' || c == '<' || c == '>' || c == '!';
@@ -63,23 +138,21 @@ bool Lexer::isOperator(char c) {
 Token Lexer::readNumber() {
     int startLine = line;
     int startColumn = column;
-    std::string value;
+    size_t start = position;
     
-    while (currentChar != '\0' && std::isdigit(currentChar)) {
-        value += currentChar;
+    while (currentChar != '\0' && isDigit(currentChar)) {
         advance();
     }
     
-    if (currentChar == '.' && std::isdigit(peek())) {
-        value += currentChar;
+    if (currentChar == '.' && isDigit(peek())) {
         advance();
         
-        while (currentChar != '\0' && std::isdigit(currentChar)) {
-            value += currentChar;
+        while (currentChar != '\0' && isDigit(currentChar)) {
             advance();
         }
     }
     
+    std::string value(source, start, position - start);
     return Token(TokenType::NUMBER, value, startLine, startColumn);
 }
 
@@ -88,16 +161,22 @@ Token Lexer::readIdentifier() {
     int startColumn = column;
     std::string value;
     
-    while (currentChar != '\0' && (std::isalnum(currentChar) || currentChar == '_')) {
-        value += currentChar;
+    size_t start = position;
+    while (currentChar != '\0' && isIdentifierContinue()) {
         advance();
+        // the rest of a multi-byte letter
+        while (isUtf8Continuation(currentChar)) {
+            advance();
+        }
     }
+    value.assign(source, start, position - start);
     
     if (isKeyword(value)) {
         return Token(TokenType::KEYWORD, value, startLine, startColumn);
     }
     
-    return Token(TokenType::IDENTIFIER, value, startLine, startColumn);
+    return Token(TokenType::IDENTIFIER, value, startLine, startColumn,
+                 StringInterner::global().intern(value));
 }
 
 Token Lexer::readString() {
@@ -149,11 +228,12 @@ Token Lexer::readOperator() {
 }
 
 std::vector<Token> Lexer::tokensize() {
+    validateEncoding();
     std::vector<Token> tokens;
     
     while (currentChar != '\0') {
 	    //skip space
-        if (std::isspace(currentChar)) {
+        if (isSpace(currentChar)) {
             skipWhitespace();
             continue;
         }
@@ -165,12 +245,12 @@ std::vector<Token> Lexer::tokensize() {
         }
         
         // numbers
-        if (std::isdigit(currentChar)) {
+        if (isDigit(currentChar)) {
             tokens.push_back(readNumber());
             continue;
         }
         
-        if (std::isalpha(currentChar) || currentChar == '_') {
+        if (isIdentifierStart()) {
             tokens.push_back(readIdentifier());
             continue;
         }
@@ -206,12 +286,22 @@ std::vector<Token> Lexer::tokensize() {
                 tokens.push_back(Token(TokenType::SEMICOLN, ";", line, column));
                 advance();
                 break;
-            default:
-                // unknown symbol
-                std::string unknown(1, currentChar);
-                tokens.push_back(Token(TokenType::UNKNOWN, unknown, line, column));
+            case ',':
+                tokens.push_back(Token(TokenType::COMMA, ",", line, column));
                 advance();
                 break;
+            default: {
+                // unknown symbol, a whole code point if it is not ASCII
+                int startColumn = column;
+                size_t start = position;
+                advance();
+                while (isUtf8Continuation(currentChar)) {
+                    advance();
+                }
+                tokens.push_back(Token(TokenType::UNKNOWN, source.substr(start, position - start),
+                                       line, startColumn));
+                break;
+            }
         }
     }
     
@@ -221,28 +311,49 @@ std::vector<Token> Lexer::tokensize() {
     return tokens;
 }
 
-void Lexer::printTokens(const std::vector<Token>& tokens) {
-    std::cout << "\n=== TOKENS ===\n\n";
+const char* tokenTypeName(TokenType type) {
+    switch (type) {
+        case TokenType::NUMBER:     return "NUMBER";
+        case TokenType::IDENTIFIER: return "IDENTIFIER";
+        case TokenType::KEYWORD:    return "KEYWORD";
+        case TokenType::OPERATOR:   return "OPERATOR";
+        case TokenType::LPAREN:     return "LPAREN";
+        case TokenType::RPAREN:     return "RPAREN";
+        case TokenType::LBRACE:     return "LBRACE";
+        case TokenType::RBRACE:     return "RBRACE";
+        case TokenType::SEMICOLN:   return "SEMICOLN";
+        case TokenType::STRING:     return "STRING";
+        case TokenType::COMMENT:    return "COMMENT";
+        case TokenType::COMMA:      return "COMMA";
+        case TokenType::UNKNOWN:    return "UNKNOWN";
+        case TokenType::END:        return "END";
+    }
+    return "UNKNOWN";
+}
+
+void Lexer::printTokens(const std::vector<Token>& tokens, std::ostream& out) {
+    out << "\n=== TOKENS ===\n\n";
     
     for (const auto& token : tokens) {
-        std::cout << "Line " << token.line << ", Col " << token.column << ": ";
+        out << "Line " << token.line << ", Col " << token.column << ": ";
         
         switch (token.type) {
-            case TokenType::NUMBER:     std::cout << "NUMBER    "; break;
-            case TokenType::IDENTIFIER: std::cout << "IDENTIFIER"; break;
-            case TokenType::KEYWORD:    std::cout << "KEYWORD   "; break;
-            case TokenType::OPERATOR:   std::cout << "OPERATOR  "; break;
-            case TokenType::LPAREN:     std::cout << "LPAREN    "; break;
-            case TokenType::RPAREN:     std::cout << "RPAREN    "; break;
-            case TokenType::LBRACE:     std::cout << "LBRACE    "; break;
-            case TokenType::RBRACE:     std::cout << "RBRACE    "; break;
-            case TokenType::SEMICOLN:  std::cout << "SEMICOLN "; break;
-            case TokenType::STRING:     std::cout << "STRING    "; break;
-            case TokenType::COMMENT:    std::cout << "COMMENT   "; break;
-            case TokenType::UNKNOWN:    std::cout << "UNKNOWN   "; break;
-            case TokenType::END:        std::cout << "END       "; break;
+            case TokenType::NUMBER:     out << "NUMBER    "; break;
+            case TokenType::IDENTIFIER: out << "IDENTIFIER"; break;
+            case TokenType::KEYWORD:    out << "KEYWORD   "; break;
+            case TokenType::OPERATOR:   out << "OPERATOR  "; break;
+            case TokenType::LPAREN:     out << "LPAREN    "; break;
+            case TokenType::RPAREN:     out << "RPAREN    "; break;
+            case TokenType::LBRACE:     out << "LBRACE    "; break;
+            case TokenType::RBRACE:     out << "RBRACE    "; break;
+            case TokenType::SEMICOLN:  out << "SEMICOLN "; break;
+            case TokenType::STRING:     out << "STRING    "; break;
+            case TokenType::COMMENT:    out << "COMMENT   "; break;
+            case TokenType::COMMA:      out << "COMMA     "; break;
+            case TokenType::UNKNOWN:    out << "UNKNOWN   "; break;
+            case TokenType::END:        out << "END       "; break;
         }
         
-        std::cout << "  \"" << token.value << "\"\n";
+        out << "  \"" << token.value << "\"\n";
     }
 }
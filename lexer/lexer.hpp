@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <cctype>
+#include <iostream>
+#include "../util/interner.hpp"
 
 //TOKEN types
 enum class TokenType{
@@ -23,20 +25,31 @@ enum class TokenType{
 	END,
 };
 
+const char* tokenTypeName(TokenType type);
+
 struct Token{
 	TokenType type;
 	std::string value;
 	int line;
 	int column;
+	SymbolId symbol; // interned id of an IDENTIFIER, NO_SYMBOL otherwise
+
+	Token() : type(TokenType::UNKNOWN), value(""), line(0), column(0), symbol(NO_SYMBOL) {}
+	Token(TokenType t, const std::string& v, int l, int c, SymbolId s = NO_SYMBOL)
+		:type(t), value(v), line(l), column(c), symbol(s) {}
+};
+
+struct LexerOptions{
+	bool unicodeIdentifiers; // non-ASCII letters (C11 Annex D) in identifiers
 
-	Token() : type(TokenType::UNKNOWN), value(""), line(0), column(0) {}
-	Token(TokenType t, const std::string& v, int l, int c)
-		:type(t), value(v), line(l), column(c) {}
+	LexerOptions() : unicodeIdentifiers(false) {}
 };
 
+// Source must be valid UTF-8; columns count code points, not bytes.
 class Lexer{
 private:
 	std::string source; // source code  (исходный код)
+	LexerOptions options;
 	size_t position;
 	int line;
 	int column;
@@ -44,7 +57,8 @@ private:
 
 	const std::vector<std::string> keywords = {
 		"if", "else", "while", "for", "return",
-		"int", "float", "string", "bool", "true", "false"
+		"int", "float", "string", "bool", "true", "false", "void",
+		"import"
 	};
 
 	void advance();   // go to next symbol
@@ -59,10 +73,13 @@ private:
 
 	bool isKeyword(const std::string& str);
 	bool isOperator(char c);
+	bool isIdentifierStart();
+	bool isIdentifierContinue();
+	void validateEncoding();
 public:
-	Lexer(const std::string& src);
+	Lexer(const std::string& src, const LexerOptions& opts = LexerOptions());
 	std::vector<Token> tokensize();
-	void printTokens(const std::vector<Token>& tokens);
+	void printTokens(const std::vector<Token>& tokens, std::ostream& out = std::cout);
 			
 };
 #endif
@@ -17,7 +17,14 @@ int main(){
 	std::vector<Token> tokens = lexer.tokensize();
 	lexer.printTokens(tokens);
 
-	//example 2 read a file
+	// example 2 UTF-8: columns count characters, Unicode identifiers are opt-in
+	LexerOptions options;
+	options.unicodeIdentifiers = true;
+	Lexer unicodeLexer("// комментарий\nint счёт = 1; print(\"привет\");", options);
+	std::vector<Token> unicodeTokens = unicodeLexer.tokensize();
+	unicodeLexer.printTokens(unicodeTokens);
+
+	//example 3 read a file
 	/*
 	std::ifstream file("test.txt");
 	if(file.is_open()){
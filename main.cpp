@@ -1,10 +1,196 @@
-#include "lexer/lexer.hpp"
-#include "parser/parser.hpp"
+#include "driver/driver.hpp"
+#include "instrument/instrumentation.hpp"
+#include "util/alloc_counter.hpp"
+#include "server/compile_client.hpp"
+#include "server/compile_server.hpp"
+#include "module/module_loader.hpp"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <unistd.h>
 
-int main() {
+struct DriverOptions {
+    std::string inputPath;   // embedded example when empty
+    bool timeReport;
+    bool stats;
+    std::string statsJsonPath;
+    std::string tracePath;
+    std::string serveSocket;   // --serve: run as a compile server
+    std::string clientSocket;  // --client: compile on a running server
+    size_t threads;  // server workers, or per-function compile threads
+    bool shutdownServer;
+    LexerOptions lexer;
+    bool profile;
+    ProfileMode profileMode;
+    int profileIntervalUs;
+    std::string profileFoldedPath;  // folded stacks for flame graphs
+    std::string profileReportPath;  // annotated source, stderr when empty
+    
+    DriverOptions()
+        : timeReport(false), stats(false), threads(0), shutdownServer(false),
+          profile(false), profileMode(ProfileMode::SAMPLE), profileIntervalUs(1000) {}
+    bool instrumented() const {
+        return timeReport || stats || !statsJsonPath.empty() || !tracePath.empty();
+    }
+};
+
+static bool parseOptions(int argc, char* argv[], DriverOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--time-report") {
+            options.timeReport = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg.compare(0, 13, "--stats-json=") == 0) {
+            options.statsJsonPath = arg.substr(13);
+        } else if (arg.compare(0, 8, "--trace=") == 0) {
+            options.tracePath = arg.substr(8);
+        } else if (arg.compare(0, 8, "--serve=") == 0) {
+            options.serveSocket = arg.substr(8);
+        } else if (arg.compare(0, 9, "--client=") == 0) {
+            options.clientSocket = arg.substr(9);
+        } else if (arg.compare(0, 10, "--threads=") == 0) {
+            options.threads = std::strtoul(arg.c_str() + 10, nullptr, 10);
+        } else if (arg == "--shutdown") {
+            options.shutdownServer = true;
+        } else if (arg == "--unicode-identifiers") {
+            options.lexer.unicodeIdentifiers = true;
+        } else if (arg.compare(0, 10, "--profile=") == 0 &&
+                   parseProfileMode(arg.substr(10), options.profileMode)) {
+            options.profile = true;
+        } else if (arg.compare(0, 19, "--profile-interval=") == 0) {
+            options.profileIntervalUs = std::atoi(arg.c_str() + 19);
+        } else if (arg.compare(0, 17, "--profile-folded=") == 0) {
+            options.profileFoldedPath = arg.substr(17);
+        } else if (arg.compare(0, 17, "--profile-report=") == 0) {
+            options.profileReportPath = arg.substr(17);
+        } else if (arg.compare(0, 2, "--") == 0 || !options.inputPath.empty()) {
+            std::cerr << "Неизвестный аргумент: " << arg << std::endl;
+            std::cerr << "Использование: compiler [--time-report] [--stats] "
+                      << "[--stats-json=FILE|-] [--trace=FILE]\n"
+                      << "                        [--unicode-identifiers] [--profile=sample|count]\n"
+                      << "                        [--profile-interval=US] [--profile-folded=FILE]\n"
+                      << "                        [--profile-report=FILE] [--threads=N] [file]\n"
+                      << "               compiler --serve=SOCKET [--threads=N]\n"
+                      << "               compiler --client=SOCKET [--shutdown] [file]" << std::endl;
+            return false;
+        } else {
+            options.inputPath = arg;
+        }
+    }
+    return true;
+}
+
+static void writeReports(const DriverOptions& options) {
+    Instrumentation& instrumentation = Instrumentation::instance();
+    if (options.timeReport) {
+        instrumentation.printTimeReport(std::cerr);
+    }
+    if (options.stats) {
+        instrumentation.printStats(std::cerr);
+    }
+    if (options.statsJsonPath == "-") {
+        instrumentation.printJson(std::cout);
+    } else if (!options.statsJsonPath.empty()) {
+        std::ofstream out(options.statsJsonPath);
+        instrumentation.printJson(out);
+    }
+    if (!options.tracePath.empty() && !instrumentation.writeChromeTrace(options.tracePath)) {
+        std::cerr << "Не удалось записать " << options.tracePath << std::endl;
+    }
+}
+
+static void writeProfile(const DriverOptions& options, const Profiler& profiler,
+                         const std::string& code) {
+    if (options.profileReportPath.empty()) {
+        profiler.writeAnnotatedSource(code, std::cerr);
+    } else {
+        std::ofstream out(options.profileReportPath);
+        profiler.writeAnnotatedSource(code, out);
+    }
+    if (options.profileFoldedPath.empty()) {
+        return;
+    }
+    if (profiler.mode() != ProfileMode::SAMPLE) {
+        std::cerr << "Стеки для flame graph есть только в режиме --profile=sample" << std::endl;
+        return;
+    }
+    std::ofstream out(options.profileFoldedPath);
+    if (!out) {
+        std::cerr << "Не удалось записать " << options.profileFoldedPath << std::endl;
+        return;
+    }
+    profiler.writeFolded(out);
+}
+
+static int serve(const DriverOptions& options) {
+    setAllocCounting(false);
+    CompileServer server(options.serveSocket, options.threads);
+    std::string error;
+    if (!server.listen(error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::cerr << "Сервер компиляции слушает " << options.serveSocket << std::endl;
+    server.run();
+    std::cerr << "Сервер остановлен: запросов " << server.requestCount()
+              << ", из кэша " << server.cacheHitCount() << std::endl;
+    return 0;
+}
+
+// Sends the file (or the source text) to the server and prints its reply
+// as if it had been compiled here. Returns -1 if no server is listening.
+static int runOnServer(const DriverOptions& options, const std::string& code) {
+    int fd = connectToServer(options.clientSocket);
+    if (fd < 0) {
+        return -1;
+    }
+    CompileRequest request;
+    if (options.lexer.unicodeIdentifiers) {
+        request.flags |= REQUEST_UNICODE_IDENTIFIERS;
+    }
+    if (options.shutdownServer) {
+        request.kind = RequestKind::SHUTDOWN;
+    } else if (!options.inputPath.empty()) {
+        // the server has its own working directory
+        char resolved[PATH_MAX];
+        request.kind = RequestKind::PATH;
+        request.payload = realpath(options.inputPath.c_str(), resolved) ? resolved : options.inputPath;
+    } else {
+        request.kind = RequestKind::SOURCE;
+        request.payload = code;
+    }
+    
+    CompileResponse response;
+    bool ok = sendCompileRequest(fd, request, response);
+    close(fd);
+    if (!ok) {
+        std::cerr << "Сервер компиляции разорвал соединение" << std::endl;
+        return 1;
+    }
+    std::cout << response.output << std::flush;
+    std::cerr << response.errors << std::flush;
+    return response.status;
+}
+
+int main(int argc, char* argv[]) {
+    DriverOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    if (!options.serveSocket.empty()) {
+        return serve(options);
+    }
+    
+    if (options.instrumented()) {
+        Instrumentation::instance().enable();
+    } else {
+        setAllocCounting(false);
+    }
+    
     std::string code = R"(
         // Объявление переменных
         int x = 42;
@@ -30,24 +216,54 @@ int main() {
         print("Hello, World!");
     )";
     
-    try {
-        std::cout << "--- ЛЕКСИЧЕСКИЙ АНАЛИЗ ---" << std::endl;
-        Lexer lexer(code);
-        std::vector<Token> tokens = lexer.tokensize();
-        lexer.printTokens(tokens);
-        
-        std::cout << "\n--- СИНТАКСИЧЕСКИЙ АНАЛИЗ ---" << std::endl;
-        Parser parser(tokens);
-        auto ast = parser.parse();
-        
-        
-        parser.printAST(ast);
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Ошибка: " << e.what() << std::endl;
-        return 1;
+    // the server does not profile, such runs stay in this process
+    if (!options.clientSocket.empty() && !options.profile) {
+        int status = runOnServer(options, code);
+        if (status >= 0 || options.shutdownServer) {
+            return status < 0 ? 1 : status;
+        }
+        // no server running: compile in this process like the plain CLI
     }
     
-    return 0;
+    if (!options.inputPath.empty()) {
+        std::ifstream file(options.inputPath);
+        if (!file.is_open()) {
+            std::cerr << "Не удалось открыть файл " << options.inputPath << std::endl;
+            return 1;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        code = buffer.str();
+    }
+    
+    std::unique_ptr<Profiler> profiler;
+    if (options.profile) {
+        profiler.reset(new Profiler(options.profileMode, options.profileIntervalUs));
+    }
+    
+    // imports and function bodies are compiled on it; one thread means inline
+    std::unique_ptr<ThreadPool> pool;
+    size_t threads = options.threads > 0 ? options.threads : std::thread::hardware_concurrency();
+    if (threads > 1) {
+        pool.reset(new ThreadPool(threads));
+    }
+    
+    CompileOptions compileOptions;
+    compileOptions.lexer = options.lexer;
+    compileOptions.profiler = profiler.get();
+    compileOptions.pool = pool.get();
+    if (!options.inputPath.empty()) {
+        compileOptions.directory = directoryOf(options.inputPath);
+    }
+    
+    int status;
+    {
+        ScopedPhase total("total");
+        status = compileSource(code, std::cout, std::cerr, compileOptions);
+    }
+    writeReports(options);
+    if (profiler) {
+        writeProfile(options, *profiler, code);
+    }
+    return status;
 }
-
@@ -0,0 +1,507 @@
+#include "interface_file.hpp"
+#include "../util/hash.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+const unsigned char InterfaceFile::VERSION;
+
+namespace {
+
+const char MAGIC[3] = {'C', 'M', 'I'};
+
+enum NodeTag : unsigned char {
+    TAG_NUMBER = 1,
+    TAG_STRING,
+    TAG_IDENTIFIER,
+    TAG_BINARY,
+    TAG_CALL,
+    TAG_DECLARATION,
+    TAG_ASSIGNMENT,
+    TAG_IF,
+    TAG_WHILE,
+    TAG_BLOCK,
+    TAG_RETURN,
+    TAG_INT_TO_FLOAT,
+};
+
+// deeper than anything the checked parser output holds: a left-leaning
+// operator chain inside the deepest statement nesting, plus a conversion
+// around each of the nested call arguments
+const size_t MAX_DEPTH = 2 * Parser::MAX_NESTING + Parser::MAX_EXPRESSION_OPERATORS;
+
+void putFixed64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out += static_cast<char>(value >> (8 * i));
+    }
+}
+
+void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void putBytes(std::string& out, const std::string& bytes) {
+    putVarint(out, bytes.size());
+    out += bytes;
+}
+
+class Encoder {
+private:
+    std::string out;
+    std::vector<const std::string*> strings;
+    std::unordered_map<std::string, uint32_t> stringIds;
+
+    void string(const std::string& value) {
+        auto it = stringIds.find(value);
+        if (it == stringIds.end()) {
+            it = stringIds.insert(std::make_pair(value, static_cast<uint32_t>(strings.size()))).first;
+            strings.push_back(&it->first);
+        }
+        putVarint(out, it->second);
+    }
+
+    void symbol(SymbolId id) {
+        string(symbolName(id));
+    }
+
+    void tag(NodeTag kind, const ASTNode* node) {
+        out += static_cast<char>(kind);
+        out += static_cast<char>(node->staticType);
+    }
+
+    void optional(const ASTNode* node) {
+        out += static_cast<char>(node ? 1 : 0);
+        if (node) {
+            this->node(node);
+        }
+    }
+
+public:
+    void node(const ASTNode* node) {
+        if (auto number = dynamic_cast<const NumberNode*>(node)) {
+            tag(TAG_NUMBER, node);
+            string(number->value);
+        } else if (auto str = dynamic_cast<const StringNode*>(node)) {
+            tag(TAG_STRING, node);
+            string(str->value);
+        } else if (auto identifier = dynamic_cast<const IdentifierNode*>(node)) {
+            tag(TAG_IDENTIFIER, node);
+            symbol(identifier->name);
+        } else if (auto binary = dynamic_cast<const BinaryOpNode*>(node)) {
+            tag(TAG_BINARY, node);
+            string(binary->op);
+            this->node(binary->left.get());
+            this->node(binary->right.get());
+        } else if (auto call = dynamic_cast<const FunctionCallNode*>(node)) {
+            tag(TAG_CALL, node);
+            symbol(call->name);
+            putVarint(out, call->arguments.size());
+            for (const auto& arg : call->arguments) {
+                this->node(arg.get());
+            }
+        } else if (auto conversion = dynamic_cast<const IntToFloatNode*>(node)) {
+            tag(TAG_INT_TO_FLOAT, node);
+            this->node(conversion->operand.get());
+        } else if (auto decl = dynamic_cast<const VarDeclarationNode*>(node)) {
+            tag(TAG_DECLARATION, node);
+            string(decl->type);
+            symbol(decl->name);
+            optional(decl->initializer.get());
+        } else if (auto assign = dynamic_cast<const AssignmentNode*>(node)) {
+            tag(TAG_ASSIGNMENT, node);
+            symbol(assign->name);
+            this->node(assign->value.get());
+        } else if (auto ifNode = dynamic_cast<const IfNode*>(node)) {
+            tag(TAG_IF, node);
+            this->node(ifNode->condition.get());
+            statements(ifNode->thenBody);
+            statements(ifNode->elseBody);
+        } else if (auto whileNode = dynamic_cast<const WhileNode*>(node)) {
+            tag(TAG_WHILE, node);
+            this->node(whileNode->condition.get());
+            statements(whileNode->body);
+        } else if (auto block = dynamic_cast<const BlockNode*>(node)) {
+            tag(TAG_BLOCK, node);
+            statements(block->statements);
+        } else if (auto ret = dynamic_cast<const ReturnNode*>(node)) {
+            tag(TAG_RETURN, node);
+            optional(ret->value.get());
+        } else {
+            throw std::runtime_error("Узел не поддерживается файлом интерфейса: " + node->toString());
+        }
+    }
+
+    void count(size_t n) {
+        putVarint(out, n);
+    }
+
+    void statements(const StatementList& body) {
+        putVarint(out, body.size());
+        for (const auto& stmt : body) {
+            node(stmt.get());
+        }
+    }
+
+    void signature(const FunctionDefNode& function) {
+        symbol(function.name);
+        string(function.returnType);
+        putVarint(out, function.parameters.size());
+        for (const auto& parameter : function.parameters) {
+            string(parameter.type);
+            symbol(parameter.name);
+        }
+    }
+
+    // the string table goes first, so it is only complete after the rest
+    void finish(std::string& file) const {
+        putVarint(file, strings.size());
+        for (const std::string* value : strings) {
+            putBytes(file, *value);
+        }
+        file += out;
+    }
+};
+
+class Decoder {
+private:
+    const unsigned char* pos;
+    const unsigned char* end;
+    std::vector<std::string> strings;
+    std::vector<SymbolId> symbols;  // interned on first use
+    size_t depth;
+
+    static void damaged() {
+        throw std::runtime_error("Файл интерфейса повреждён");
+    }
+
+    unsigned char byte() {
+        if (pos == end) {
+            damaged();
+        }
+        return *pos++;
+    }
+
+    const std::string& string() {
+        uint64_t index = varint();
+        if (index >= strings.size()) {
+            damaged();
+        }
+        return strings[index];
+    }
+
+    SymbolId symbol() {
+        uint64_t index = varint();
+        if (index >= strings.size()) {
+            damaged();
+        }
+        if (symbols[index] == NO_SYMBOL) {
+            symbols[index] = StringInterner::global().intern(strings[index]);
+        }
+        return symbols[index];
+    }
+
+    std::unique_ptr<ASTNode> optional() {
+        return byte() ? node() : nullptr;
+    }
+
+public:
+    // a count of items that take at least a byte each
+    size_t count() {
+        uint64_t n = varint();
+        if (n > static_cast<uint64_t>(end - pos)) {
+            damaged();
+        }
+        return static_cast<size_t>(n);
+    }
+
+    Decoder(const unsigned char* data, size_t size) : pos(data), end(data + size), depth(0) {}
+
+    size_t offsetFrom(const unsigned char* data) const { return pos - data; }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            unsigned char b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        damaged();
+        return 0;
+    }
+
+    uint64_t fixed64() {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(byte()) << (8 * i);
+        }
+        return value;
+    }
+
+    std::string bytes() {
+        size_t length = count();
+        std::string value(reinterpret_cast<const char*>(pos), length);
+        pos += length;
+        return value;
+    }
+
+    bool expect(const char* text, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            if (pos == end || *pos++ != static_cast<unsigned char>(text[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void readStrings() {
+        size_t n = count();
+        strings.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            strings.push_back(bytes());
+        }
+        symbols.assign(n, NO_SYMBOL);
+    }
+
+    std::unique_ptr<FunctionDefNode> signature() {
+        SymbolId name = symbol();
+        std::unique_ptr<FunctionDefNode> function(new FunctionDefNode(string(), name));
+        size_t n = count();
+        for (size_t i = 0; i < n; ++i) {
+            Parameter parameter;
+            parameter.type = string();
+            parameter.name = symbol();
+            function->parameters.push_back(parameter);
+        }
+        return function;
+    }
+
+    std::unique_ptr<ASTNode> node() {
+        if (++depth > MAX_DEPTH) {
+            damaged();
+        }
+        unsigned char kind = byte();
+        unsigned char type = byte();
+        if (type > static_cast<unsigned char>(StaticType::VOID)) {
+            damaged();
+        }
+
+        std::unique_ptr<ASTNode> result;
+        switch (kind) {
+            case TAG_NUMBER:
+                result.reset(new NumberNode(string()));
+                break;
+            case TAG_STRING:
+                result.reset(new StringNode(string()));
+                break;
+            case TAG_IDENTIFIER:
+                result.reset(new IdentifierNode(symbol()));
+                break;
+            case TAG_BINARY: {
+                std::string op = string();
+                auto left = node();
+                auto right = node();
+                result.reset(new BinaryOpNode(op, std::move(left), std::move(right)));
+                break;
+            }
+            case TAG_CALL: {
+                std::unique_ptr<FunctionCallNode> call(new FunctionCallNode(symbol()));
+                size_t n = count();
+                for (size_t i = 0; i < n; ++i) {
+                    call->arguments.push_back(node());
+                }
+                result = std::move(call);
+                break;
+            }
+            case TAG_INT_TO_FLOAT:
+                result.reset(new IntToFloatNode(node()));
+                break;
+            case TAG_DECLARATION: {
+                std::string declared = string();
+                SymbolId name = symbol();
+                result.reset(new VarDeclarationNode(declared, name, optional()));
+                break;
+            }
+            case TAG_ASSIGNMENT: {
+                SymbolId name = symbol();
+                result.reset(new AssignmentNode(name, node()));
+                break;
+            }
+            case TAG_IF: {
+                std::unique_ptr<IfNode> ifNode(new IfNode(node()));
+                statements(ifNode->thenBody);
+                statements(ifNode->elseBody);
+                result = std::move(ifNode);
+                break;
+            }
+            case TAG_WHILE: {
+                std::unique_ptr<WhileNode> whileNode(new WhileNode(node()));
+                statements(whileNode->body);
+                result = std::move(whileNode);
+                break;
+            }
+            case TAG_BLOCK: {
+                std::unique_ptr<BlockNode> block(new BlockNode());
+                statements(block->statements);
+                result = std::move(block);
+                break;
+            }
+            case TAG_RETURN:
+                result.reset(new ReturnNode(optional()));
+                break;
+            default:
+                damaged();
+        }
+        result->staticType = static_cast<StaticType>(type);
+        --depth;
+        return result;
+    }
+
+    void statements(StatementList& body) {
+        size_t n = count();
+        body.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            body.push_back(node());
+        }
+    }
+
+    bool atEnd() const { return pos == end; }
+};
+
+}  // namespace
+
+InterfaceFile::InterfaceFile()
+    : data(nullptr), size(0), payloadSize(0), source(0), moduleKey(0), stringsOffset(0) {}
+
+InterfaceFile::~InterfaceFile() {
+    if (data) {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+}
+
+bool InterfaceFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    if (data) {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+    data = static_cast<const unsigned char*>(mapped);
+    size = static_cast<size_t>(info.st_size);
+
+    try {
+        if (size < 8) {
+            return false;
+        }
+        payloadSize = size - 8;
+        Decoder trailer(data + payloadSize, 8);
+        if (trailer.fixed64() != fnv1a(data, payloadSize)) {
+            return false;
+        }
+        Decoder header(data, payloadSize);
+        const char version = static_cast<char>(VERSION);
+        if (!header.expect(MAGIC, sizeof(MAGIC)) || !header.expect(&version, 1)) {
+            return false;
+        }
+        source = header.fixed64();
+        moduleKey = header.fixed64();
+        importPaths.clear();
+        uint64_t imports = header.varint();
+        for (uint64_t i = 0; i < imports; ++i) {
+            importPaths.push_back(header.bytes());
+        }
+        stringsOffset = header.offsetFrom(data);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    return true;
+}
+
+StatementList InterfaceFile::decodeFunctions() const {
+    Decoder decoder(data + stringsOffset, payloadSize - stringsOffset);
+    decoder.readStrings();
+
+    StatementList functions;
+    size_t count = decoder.count();
+    for (size_t i = 0; i < count; ++i) {
+        functions.push_back(decoder.signature());
+    }
+    for (auto& function : functions) {
+        decoder.statements(static_cast<FunctionDefNode&>(*function).body);
+    }
+    if (!decoder.atEnd()) {
+        throw std::runtime_error("Файл интерфейса повреждён");
+    }
+    return functions;
+}
+
+bool writeInterfaceFile(const std::string& path, uint64_t sourceHash, uint64_t key,
+                        const std::vector<std::string>& imports, const StatementList& functions) {
+    Encoder encoder;
+    std::vector<const FunctionDefNode*> definitions;
+    for (const auto& stmt : functions) {
+        if (auto function = dynamic_cast<const FunctionDefNode*>(stmt.get())) {
+            definitions.push_back(function);
+        }
+    }
+    std::string file(MAGIC, sizeof(MAGIC));
+    file += static_cast<char>(InterfaceFile::VERSION);
+    putFixed64(file, sourceHash);
+    putFixed64(file, key);
+    putVarint(file, imports.size());
+    for (const auto& import : imports) {
+        putBytes(file, import);
+    }
+
+    encoder.count(definitions.size());
+    for (const FunctionDefNode* function : definitions) {
+        encoder.signature(*function);
+    }
+    for (const FunctionDefNode* function : definitions) {
+        encoder.statements(function->body);
+    }
+    encoder.finish(file);
+    putFixed64(file, fnv1a(file));
+
+    static std::atomic<unsigned> serial(0);
+    std::string temporary = path + ".tmp" + std::to_string(getpid()) + "-" +
+                            std::to_string(serial.fetch_add(1));
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        if (!out || !out.write(file.data(), file.size())) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string interfacePath(const std::string& modulePath) {
+    return modulePath + ".iface";
+}
@@ -0,0 +1,58 @@
+#ifndef INTERFACE_FILE_HPP
+#define INTERFACE_FILE_HPP
+
+#include "../optimizer/ast_utils.hpp"
+#include <cstdint>
+
+// Precompiled module interface, written next to the module ("lib.txt" ->
+// "lib.txt.iface") once it has been parsed and type-checked:
+//
+//   "CMI" version  u64 source hash  u64 key (source hash + dependency keys)
+//   imports        paths as written in the module
+//   strings        names, types, operators and literals, each stored once
+//   signatures     name, return type, parameter types and names
+//   bodies         checked ASTs, pre-order, with their static types
+//   u64 checksum   FNV-1a of everything before it
+//
+// Integers other than the hashes are LEB128 varints. Positions are not kept:
+// a module's line numbers mean nothing in the program that imports it.
+class InterfaceFile {
+private:
+    const unsigned char* data;
+    size_t size;           // mapped
+    size_t payloadSize;    // without the checksum
+    uint64_t source;
+    uint64_t moduleKey;
+    std::vector<std::string> importPaths;
+    size_t stringsOffset;  // where decodeFunctions() starts
+
+public:
+    static const unsigned char VERSION = 1;
+
+    InterfaceFile();
+    ~InterfaceFile();
+    InterfaceFile(const InterfaceFile&) = delete;
+    InterfaceFile& operator=(const InterfaceFile&) = delete;
+
+    // maps the file and reads its header; false if it is missing, of another
+    // version or damaged
+    bool open(const std::string& path);
+
+    uint64_t sourceHash() const { return source; }
+    uint64_t key() const { return moduleKey; }
+    const std::vector<std::string>& imports() const { return importPaths; }
+
+    // the module's function definitions; throws std::runtime_error if the
+    // file does not decode (a checksum collision or a bug in the writer)
+    StatementList decodeFunctions() const;
+};
+
+// Writes the file atomically (temporary file, then rename), so a concurrent
+// reader sees either the old file or the new one. false if it cannot be
+// written; the module is then simply parsed again next time.
+bool writeInterfaceFile(const std::string& path, uint64_t sourceHash, uint64_t key,
+                        const std::vector<std::string>& imports, const StatementList& functions);
+
+std::string interfacePath(const std::string& modulePath);
+
+#endif
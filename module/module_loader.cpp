@@ -0,0 +1,333 @@
+#include "module_loader.hpp"
+#include "../semantic/type_checker.hpp"
+#include "../util/hash.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+const size_t ModuleLoader::NO_MODULE;
+
+std::string directoryOf(const std::string& path) {
+    size_t slash = path.rfind('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+ModuleLoader::ModuleLoader(ThreadPool* pool, std::ostream& errors)
+    : pool(pool), errors(&errors), interfaceCache(true) {}
+
+size_t ModuleLoader::resolve(const std::string& importPath, const std::string& directory,
+                             const std::string& importer, std::string& error) {
+    std::string joined = !importPath.empty() && importPath[0] == '/'
+        ? importPath
+        : directory + "/" + importPath;
+    char resolved[PATH_MAX];
+    if (!realpath(joined.c_str(), resolved)) {
+        error = "Модуль " + importPath + " не найден";
+        if (!importer.empty()) {
+            error += " (импортирован из " + importer + ")";
+        }
+        return NO_MODULE;
+    }
+
+    auto it = byPath.find(resolved);
+    if (it != byPath.end()) {
+        return it->second;
+    }
+    std::unique_ptr<Module> module(new Module());
+    module->path = resolved;
+    byPath[module->path] = modules.size();
+    modules.push_back(std::move(module));
+    return modules.size() - 1;
+}
+
+// reads the source and finds the imports: from the interface file when it
+// belongs to this source, by parsing otherwise
+void ModuleLoader::scan(Module& module) {
+    std::ifstream file(module.path, std::ios::binary);
+    if (!file.is_open()) {
+        module.errors = "Не удалось открыть модуль " + module.path + "\n";
+        return;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    module.source = buffer.str();
+    module.sourceHash = fnv1a(module.source);
+
+    if (interfaceCache) {
+        std::unique_ptr<InterfaceFile> interface(new InterfaceFile());
+        if (interface->open(interfacePath(module.path)) &&
+            interface->sourceHash() == module.sourceHash) {
+            module.imports = interface->imports();
+            module.interface = std::move(interface);
+            return;
+        }
+    }
+    parse(module);
+}
+
+void ModuleLoader::parse(Module& module) {
+    module.parsed = true;
+    std::ostringstream problems;
+    StatementList program;
+    try {
+        Lexer lexer(module.source, lexerOptions);
+        Parser parser(lexer.tokensize());
+        parser.setErrorStream(problems);
+        program = parser.parse();
+    } catch (const std::exception& e) {
+        problems << "Ошибка: " << e.what() << "\n";
+    }
+
+    module.imports.clear();
+    module.functions.clear();
+    for (auto& stmt : program) {
+        if (auto import = dynamic_cast<const ImportNode*>(stmt.get())) {
+            module.imports.push_back(import->path);
+        } else if (dynamic_cast<const FunctionDefNode*>(stmt.get())) {
+            module.functions.push_back(std::move(stmt));
+        } else {
+            problems << "Строка " << stmt->line
+                     << ": в модуле допускаются только функции и import\n";
+        }
+    }
+    if (!problems.str().empty()) {
+        module.errors = "Модуль " + module.path + ":\n" + problems.str();
+    }
+}
+
+// every dependency is finished by now
+void ModuleLoader::finish(size_t index) {
+    Module& module = *modules[index];
+    module.failed = true;
+    for (size_t dependency : module.dependencies) {
+        if (modules[dependency]->failed) {
+            return;  // reported there
+        }
+    }
+
+    // a module checked against other signatures, or lexed with other
+    // options, is a different interface
+    unsigned char unicode = lexerOptions.unicodeIdentifiers ? 1 : 0;
+    module.key = fnv1a(&unicode, 1, module.sourceHash);
+    for (size_t dependency : module.dependencies) {
+        module.key = fnv1a(&modules[dependency]->key, sizeof(uint64_t), module.key);
+    }
+
+    if (module.interface && module.interface->key() == module.key) {
+        try {
+            module.functions = module.interface->decodeFunctions();
+            module.cached = true;
+        } catch (const std::runtime_error&) {
+            module.functions.clear();  // damaged file: the source is still there
+        }
+    }
+    module.interface.reset();
+
+    if (!module.cached) {
+        if (!module.parsed) {
+            parse(module);
+            if (!module.errors.empty()) {
+                return;
+            }
+        }
+
+        // everything below the module is visible, but only the names it
+        // calls are worth a place in the checker's table
+        std::unordered_set<SymbolId> called;
+        forEachNode(module.functions, [&](ASTNode& node) {
+            if (auto call = dynamic_cast<const FunctionCallNode*>(&node)) {
+                called.insert(call->name);
+            }
+        });
+        TypeChecker checker;
+        std::vector<bool> seen(modules.size(), false);
+        std::vector<const FunctionDefNode*> visible;
+        for (size_t dependency : module.dependencies) {
+            visibleFunctions(dependency, seen, visible);
+        }
+        for (const FunctionDefNode* function : visible) {
+            if (called.count(function->name)) {
+                checker.importFunction(function);
+            }
+        }
+        const std::vector<Diagnostic>& diagnostics = checker.check(module.functions);
+        if (!diagnostics.empty()) {
+            std::ostringstream report;
+            report << "Модуль " << module.path << ":\n";
+            printDiagnostics(diagnostics, report);
+            module.errors = report.str();
+            return;
+        }
+
+        if (interfaceCache) {
+            writeInterfaceFile(interfacePath(module.path), module.sourceHash, module.key,
+                               module.imports, module.functions);
+        }
+        // the module's line numbers mean nothing in the program: runtime
+        // errors and profiles go to the calling line instead
+        forEachNode(module.functions, [](ASTNode& node) {
+            node.line = 0;
+            node.column = 0;
+        });
+    }
+    std::string().swap(module.source);
+    module.failed = false;
+}
+
+// level = 1 + the highest level among the imports; false on a cycle
+bool ModuleLoader::assignLevel(size_t index, std::vector<int>& state, std::vector<size_t>& path) {
+    const int VISITING = 1, DONE = 2;  // 0: not visited yet
+    if (state[index] == DONE) {
+        return true;
+    }
+    if (state[index] == VISITING) {
+        std::string cycle;
+        size_t start = std::find(path.begin(), path.end(), index) - path.begin();
+        for (size_t i = start; i < path.size(); ++i) {
+            cycle += modules[path[i]]->path + " -> ";
+        }
+        *errors << "Циклический импорт: " << cycle << modules[index]->path << std::endl;
+        return false;
+    }
+
+    state[index] = VISITING;
+    path.push_back(index);
+    Module& module = *modules[index];
+    for (size_t dependency : module.dependencies) {
+        if (!assignLevel(dependency, state, path)) {
+            return false;
+        }
+        module.level = std::max(module.level, modules[dependency]->level + 1);
+    }
+    path.pop_back();
+    state[index] = DONE;
+    return true;
+}
+
+void ModuleLoader::visibleFunctions(size_t index, std::vector<bool>& seen,
+                                    std::vector<const FunctionDefNode*>& functions) const {
+    if (seen[index]) {
+        return;
+    }
+    seen[index] = true;
+    const Module& module = *modules[index];
+    for (const auto& function : module.functions) {
+        functions.push_back(static_cast<const FunctionDefNode*>(function.get()));
+    }
+    for (size_t dependency : module.dependencies) {
+        visibleFunctions(dependency, seen, functions);
+    }
+}
+
+bool ModuleLoader::reportErrors() {
+    bool failed = false;
+    for (const auto& module : modules) {
+        if (!module->errors.empty()) {
+            *errors << module->errors;
+            failed = true;
+        }
+    }
+    errors->flush();
+    return failed;
+}
+
+bool ModuleLoader::load(const StatementList& program, const std::string& directory) {
+    bool failed = false;
+    std::string error;
+    for (const auto& stmt : program) {
+        if (auto import = dynamic_cast<const ImportNode*>(stmt.get())) {
+            if (resolve(import->path, directory, "", error) == NO_MODULE) {
+                *errors << "Строка " << import->line << ": " << error << std::endl;
+                failed = true;
+            }
+        }
+    }
+
+    // discovery, one ring of newly found modules at a time
+    size_t scanned = 0;
+    while (scanned < modules.size()) {
+        size_t end = modules.size();
+        parallelFor(pool, end - scanned, [&](size_t i) {
+            scan(*modules[scanned + i]);
+        });
+        for (size_t index = scanned; index < end; ++index) {
+            Module& module = *modules[index];
+            std::string moduleDirectory = directoryOf(module.path);
+            for (const std::string& import : module.imports) {
+                size_t dependency = resolve(import, moduleDirectory, module.path, error);
+                if (dependency == NO_MODULE) {
+                    module.errors += error + "\n";
+                } else {
+                    module.dependencies.push_back(dependency);
+                }
+            }
+        }
+        scanned = end;
+    }
+    if (reportErrors() || failed) {
+        return false;
+    }
+
+    std::vector<int> state(modules.size(), 0);
+    std::vector<size_t> path;
+    size_t depth = 0;
+    for (size_t index = 0; index < modules.size(); ++index) {
+        if (!assignLevel(index, state, path)) {
+            return false;
+        }
+        depth = std::max(depth, modules[index]->level + 1);
+    }
+    std::vector<std::vector<size_t>> levels(depth);
+    for (size_t index = 0; index < modules.size(); ++index) {
+        levels[modules[index]->level].push_back(index);
+    }
+    for (const auto& level : levels) {
+        parallelFor(pool, level.size(), [&](size_t i) {
+            finish(level[i]);
+        });
+    }
+    if (reportErrors()) {
+        return false;
+    }
+
+    // every module becomes part of one program, where a name means one function
+    std::unordered_map<SymbolId, size_t> owner;
+    for (size_t index = 0; index < modules.size(); ++index) {
+        for (const auto& stmt : modules[index]->functions) {
+            SymbolId name = static_cast<const FunctionDefNode*>(stmt.get())->name;
+            auto inserted = owner.insert(std::make_pair(name, index));
+            if (!inserted.second && inserted.first->second != index) {
+                *errors << "Функция " << symbolName(name) << " объявлена в модулях "
+                        << modules[inserted.first->second]->path << " и "
+                        << modules[index]->path << std::endl;
+                failed = true;
+            }
+        }
+    }
+    return !failed;
+}
+
+StatementList ModuleLoader::takeFunctions() {
+    StatementList functions;
+    for (auto& module : modules) {
+        for (auto& function : module->functions) {
+            functions.push_back(std::move(function));
+        }
+        module->functions.clear();
+    }
+    return functions;
+}
+
+size_t ModuleLoader::cachedCount() const {
+    size_t count = 0;
+    for (const auto& module : modules) {
+        count += module->cached;
+    }
+    return count;
+}
@@ -0,0 +1,85 @@
+#ifndef MODULE_LOADER_HPP
+#define MODULE_LOADER_HPP
+
+#include "interface_file.hpp"
+#include "../lexer/lexer.hpp"
+#include "../util/thread_pool.hpp"
+#include <iostream>
+#include <unordered_map>
+
+// Loads the modules a program imports, each once however many files import
+// it. A module holds function definitions and imports only; importing it
+// makes its functions and those of everything it imports callable.
+//
+// A module is parsed and type-checked once, then its precompiled interface
+// (interface_file.hpp) is written next to it. Later loads map that file
+// instead while the module's source hash and the keys of its imports still
+// match, so neither the module nor anything it depends on has changed.
+//
+// Loading goes in two passes over the import graph: discovery reads sources
+// and import lists breadth-first, then modules are finished dependencies
+// first, one level of the graph at a time. Modules of a level do not depend
+// on each other and load in parallel on the pool.
+class ModuleLoader {
+private:
+    struct Module {
+        std::string path;                  // canonical
+        std::vector<std::string> imports;  // as written
+        std::vector<size_t> dependencies;  // indices into modules, by import
+        uint64_t sourceHash;
+        uint64_t key;                      // sourceHash folded with the dependencies' keys
+        std::string source;                // dropped once loaded
+        std::unique_ptr<InterfaceFile> interface;  // open while its source hash matches
+        StatementList functions;
+        bool parsed;
+        bool cached;
+        bool failed;                       // it or something it imports has errors
+        size_t level;                      // 0: imports nothing
+        std::string errors;
+
+        Module() : sourceHash(0), key(0), parsed(false), cached(false), failed(false), level(0) {}
+    };
+
+    static const size_t NO_MODULE = static_cast<size_t>(-1);
+
+    ThreadPool* pool;
+    std::ostream* errors;
+    LexerOptions lexerOptions;
+    bool interfaceCache;
+    std::vector<std::unique_ptr<Module>> modules;  // in discovery order
+    std::unordered_map<std::string, size_t> byPath;
+
+    size_t resolve(const std::string& importPath, const std::string& directory,
+                   const std::string& importer, std::string& error);
+    void scan(Module& module);
+    void parse(Module& module);
+    void finish(size_t index);
+    bool assignLevel(size_t module, std::vector<int>& state, std::vector<size_t>& path);
+    void visibleFunctions(size_t module, std::vector<bool>& seen,
+                          std::vector<const FunctionDefNode*>& functions) const;
+    bool reportErrors();
+
+public:
+    ModuleLoader(ThreadPool* pool = nullptr, std::ostream& errors = std::cerr);
+
+    void setLexerOptions(const LexerOptions& options) { lexerOptions = options; }
+    // off: modules are always parsed, .iface files are neither read nor written
+    void setInterfaceCache(bool enabled) { interfaceCache = enabled; }
+
+    // Loads everything program imports; relative paths are resolved against
+    // directory (against the importing module's directory inside modules).
+    // false after reporting errors (missing files, cycles, syntax and type
+    // errors in a module, a function defined by two modules).
+    bool load(const StatementList& program, const std::string& directory);
+
+    // moves out the functions of all modules
+    StatementList takeFunctions();
+
+    size_t moduleCount() const { return modules.size(); }
+    size_t cachedCount() const;
+};
+
+// "dir/file.txt" -> "dir", "file.txt" -> "."
+std::string directoryOf(const std::string& path);
+
+#endif
@@ -0,0 +1,128 @@
+#include "ast_utils.hpp"
+
+void forEachBody(ASTNode* stmt, const std::function<void(StatementList&)>& callback) {
+    if (auto ifNode = dynamic_cast<IfNode*>(stmt)) {
+        callback(ifNode->thenBody);
+        callback(ifNode->elseBody);
+    } else if (auto whileNode = dynamic_cast<WhileNode*>(stmt)) {
+        callback(whileNode->body);
+    } else if (auto block = dynamic_cast<BlockNode*>(stmt)) {
+        callback(block->statements);
+    }
+}
+
+void forEachExprSlot(ASTNode* stmt, const SlotCallback& callback) {
+    if (auto decl = dynamic_cast<VarDeclarationNode*>(stmt)) {
+        if (decl->initializer) callback(decl->initializer);
+    } else if (auto assign = dynamic_cast<AssignmentNode*>(stmt)) {
+        callback(assign->value);
+    } else if (auto ifNode = dynamic_cast<IfNode*>(stmt)) {
+        callback(ifNode->condition);
+    } else if (auto whileNode = dynamic_cast<WhileNode*>(stmt)) {
+        callback(whileNode->condition);
+    } else if (auto call = dynamic_cast<FunctionCallNode*>(stmt)) {
+        for (auto& arg : call->arguments) {
+            callback(arg);
+        }
+    } else if (auto ret = dynamic_cast<ReturnNode*>(stmt)) {
+        if (ret->value) callback(ret->value);
+    }
+}
+
+void forEachChildSlot(ASTNode* expr, const SlotCallback& callback) {
+    if (auto binary = dynamic_cast<BinaryOpNode*>(expr)) {
+        callback(binary->left);
+        callback(binary->right);
+    } else if (auto call = dynamic_cast<FunctionCallNode*>(expr)) {
+        for (auto& arg : call->arguments) {
+            callback(arg);
+        }
+    } else if (auto conversion = dynamic_cast<IntToFloatNode*>(expr)) {
+        callback(conversion->operand);
+    }
+}
+
+void forEachExprSlotDeep(ASTNode* stmt, const SlotCallback& callback) {
+    forEachExprSlot(stmt, callback);
+    forEachBody(stmt, [&](StatementList& body) {
+        for (auto& nested : body) {
+            forEachExprSlotDeep(nested.get(), callback);
+        }
+    });
+}
+
+void forEachSubExprSlot(std::unique_ptr<ASTNode>& slot, const SlotCallback& callback) {
+    if (!slot) {
+        return;
+    }
+    forEachChildSlot(slot.get(), [&](std::unique_ptr<ASTNode>& child) {
+        forEachSubExprSlot(child, callback);
+    });
+    callback(slot);
+}
+
+void forEachNode(StatementList& body, const std::function<void(ASTNode&)>& callback) {
+    SlotCallback visitTree = [&](std::unique_ptr<ASTNode>& slot) {
+        forEachSubExprSlot(slot, [&](std::unique_ptr<ASTNode>& node) {
+            callback(*node);
+        });
+    };
+    
+    for (auto& stmt : body) {
+        callback(*stmt);
+        if (dynamic_cast<BinaryOpNode*>(stmt.get()) || dynamic_cast<FunctionCallNode*>(stmt.get())) {
+            // expression statement: it is the root of its own tree
+            forEachChildSlot(stmt.get(), visitTree);
+        } else {
+            forEachExprSlot(stmt.get(), visitTree);
+        }
+        forEachBody(stmt.get(), [&](StatementList& nested) {
+            forEachNode(nested, callback);
+        });
+        if (auto function = dynamic_cast<FunctionDefNode*>(stmt.get())) {
+            forEachNode(function->body, callback);
+        }
+    }
+}
+
+void forEachFunction(StatementList& program, const std::function<void(FunctionDefNode&)>& callback) {
+    for (auto& stmt : program) {
+        if (auto function = dynamic_cast<FunctionDefNode*>(stmt.get())) {
+            callback(*function);
+        }
+    }
+}
+
+size_t countNodes(StatementList& body) {
+    size_t count = 0;
+    forEachNode(body, [&](ASTNode&) {
+        count++;
+    });
+    return count;
+}
+
+bool isIntLiteral(const ASTNode* node) {
+    auto number = dynamic_cast<const NumberNode*>(node);
+    return number && number->value.find('.') == std::string::npos;
+}
+
+bool isNonZeroLiteral(const ASTNode* node) {
+    auto number = dynamic_cast<const NumberNode*>(node);
+    return number && floatLiteralValue(number->value) != 0.0;
+}
+
+bool hasSideEffects(const ASTNode* expr) {
+    if (dynamic_cast<const FunctionCallNode*>(expr)) {
+        return true;
+    }
+    if (auto binary = dynamic_cast<const BinaryOpNode*>(expr)) {
+        if (binary->op == "/" && !isNonZeroLiteral(binary->right.get())) {
+            return true;  // may fail with division by zero
+        }
+        return hasSideEffects(binary->left.get()) || hasSideEffects(binary->right.get());
+    }
+    if (auto conversion = dynamic_cast<const IntToFloatNode*>(expr)) {
+        return hasSideEffects(conversion->operand.get());
+    }
+    return false;
+}
@@ -0,0 +1,41 @@
+#ifndef AST_UTILS_HPP
+#define AST_UTILS_HPP
+
+#include "../parser/parser.hpp"
+#include <functional>
+
+typedef std::vector<std::unique_ptr<ASTNode>> StatementList;
+typedef std::function<void(std::unique_ptr<ASTNode>&)> SlotCallback;
+
+// nested statement lists of a statement (if/else bodies, loop body, block);
+// function bodies are separate units and are not included
+void forEachBody(ASTNode* stmt, const std::function<void(StatementList&)>& callback);
+
+// expression slots owned directly by a statement (conditions, initializers,
+// assigned values, call arguments); nested bodies are not visited
+void forEachExprSlot(ASTNode* stmt, const SlotCallback& callback);
+
+// direct child slots of an expression node
+void forEachChildSlot(ASTNode* expr, const SlotCallback& callback);
+
+// every expression slot of a statement and of all statements nested in it
+void forEachExprSlotDeep(ASTNode* stmt, const SlotCallback& callback);
+
+// post-order walk over an expression tree, the root slot included
+void forEachSubExprSlot(std::unique_ptr<ASTNode>& slot, const SlotCallback& callback);
+
+// visits every node of the program: statements, then their expressions,
+// function bodies included
+void forEachNode(StatementList& body, const std::function<void(ASTNode&)>& callback);
+
+// function definitions of the program (they are top-level only)
+void forEachFunction(StatementList& program, const std::function<void(FunctionDefNode&)>& callback);
+size_t countNodes(StatementList& body);
+
+bool isIntLiteral(const ASTNode* node);
+bool isNonZeroLiteral(const ASTNode* node);
+// calls, and divisions that may fail at run time: not removable even when
+// the value is unused
+bool hasSideEffects(const ASTNode* expr);
+
+#endif
@@ -0,0 +1,160 @@
+#include "call_graph.hpp"
+#include <algorithm>
+
+const size_t CallGraph::TOP_LEVEL;
+
+static void collectCallsIn(const ASTNode* expr, const std::vector<size_t>& indexBySymbol,
+                           std::vector<size_t>& callees) {
+    if (auto binary = dynamic_cast<const BinaryOpNode*>(expr)) {
+        collectCallsIn(binary->left.get(), indexBySymbol, callees);
+        collectCallsIn(binary->right.get(), indexBySymbol, callees);
+    } else if (auto call = dynamic_cast<const FunctionCallNode*>(expr)) {
+        if (call->name < indexBySymbol.size() && indexBySymbol[call->name] != 0) {
+            callees.push_back(indexBySymbol[call->name]);
+        }
+        for (const auto& arg : call->arguments) {
+            collectCallsIn(arg.get(), indexBySymbol, callees);
+        }
+    } else if (auto conversion = dynamic_cast<const IntToFloatNode*>(expr)) {
+        collectCallsIn(conversion->operand.get(), indexBySymbol, callees);
+    }
+}
+
+CallGraph::CallGraph(const std::vector<std::unique_ptr<ASTNode>>& program) {
+    nodes.push_back(nullptr);
+    std::vector<size_t> indexBySymbol;  // 0: not a function
+    for (const auto& stmt : program) {
+        if (auto function = dynamic_cast<const FunctionDefNode*>(stmt.get())) {
+            if (function->name >= indexBySymbol.size()) {
+                indexBySymbol.resize(function->name + 1, 0);
+            }
+            // a redefinition is an error already, calls go to the first one
+            if (indexBySymbol[function->name] == 0) {
+                indexBySymbol[function->name] = nodes.size();
+            }
+            nodes.push_back(function);
+        }
+    }
+    
+    edges.resize(nodes.size());
+    collectCalls(program, indexBySymbol, edges[TOP_LEVEL]);
+    for (size_t node = 1; node < nodes.size(); ++node) {
+        collectCalls(nodes[node]->body, indexBySymbol, edges[node]);
+    }
+    for (auto& callees : edges) {
+        std::sort(callees.begin(), callees.end());
+        callees.erase(std::unique(callees.begin(), callees.end()), callees.end());
+    }
+}
+
+void CallGraph::collectCalls(const std::vector<std::unique_ptr<ASTNode>>& body,
+                             const std::vector<size_t>& indexBySymbol,
+                             std::vector<size_t>& callees) {
+    for (const auto& stmt : body) {
+        const ASTNode* node = stmt.get();
+        if (dynamic_cast<const FunctionDefNode*>(node)) {
+            continue;  // its calls belong to its own node
+        }
+        if (auto decl = dynamic_cast<const VarDeclarationNode*>(node)) {
+            collectCallsIn(decl->initializer.get(), indexBySymbol, callees);
+        } else if (auto assign = dynamic_cast<const AssignmentNode*>(node)) {
+            collectCallsIn(assign->value.get(), indexBySymbol, callees);
+        } else if (auto ret = dynamic_cast<const ReturnNode*>(node)) {
+            collectCallsIn(ret->value.get(), indexBySymbol, callees);
+        } else if (auto ifNode = dynamic_cast<const IfNode*>(node)) {
+            collectCallsIn(ifNode->condition.get(), indexBySymbol, callees);
+            collectCalls(ifNode->thenBody, indexBySymbol, callees);
+            collectCalls(ifNode->elseBody, indexBySymbol, callees);
+        } else if (auto whileNode = dynamic_cast<const WhileNode*>(node)) {
+            collectCallsIn(whileNode->condition.get(), indexBySymbol, callees);
+            collectCalls(whileNode->body, indexBySymbol, callees);
+        } else if (auto block = dynamic_cast<const BlockNode*>(node)) {
+            collectCalls(block->statements, indexBySymbol, callees);
+        } else {
+            collectCallsIn(node, indexBySymbol, callees);
+        }
+    }
+}
+
+size_t CallGraph::edgeCount() const {
+    size_t count = 0;
+    for (const auto& callees : edges) {
+        count += callees.size();
+    }
+    return count;
+}
+
+std::vector<bool> CallGraph::reachable() const {
+    std::vector<bool> seen(nodes.size(), false);
+    std::vector<size_t> work(1, TOP_LEVEL);
+    seen[TOP_LEVEL] = true;
+    while (!work.empty()) {
+        size_t node = work.back();
+        work.pop_back();
+        for (size_t callee : edges[node]) {
+            if (!seen[callee]) {
+                seen[callee] = true;
+                work.push_back(callee);
+            }
+        }
+    }
+    return seen;
+}
+
+// iterative Tarjan: call chains of thousands of functions must not
+// overflow the native stack
+std::vector<bool> CallGraph::recursive() const {
+    const size_t UNVISITED = static_cast<size_t>(-1);
+    size_t count = nodes.size();
+    std::vector<size_t> index(count, UNVISITED), lowLink(count, 0);
+    std::vector<bool> onStack(count, false), result(count, false);
+    std::vector<size_t> stack;
+    std::vector<std::pair<size_t, size_t>> frames;  // node, next edge
+    size_t nextIndex = 0;
+    
+    for (size_t root = 0; root < count; ++root) {
+        if (index[root] != UNVISITED) {
+            continue;
+        }
+        frames.push_back(std::make_pair(root, 0));
+        while (!frames.empty()) {
+            size_t node = frames.back().first;
+            size_t& edge = frames.back().second;
+            if (edge == 0 && index[node] == UNVISITED) {
+                index[node] = lowLink[node] = nextIndex++;
+                stack.push_back(node);
+                onStack[node] = true;
+            }
+            if (edge < edges[node].size()) {
+                size_t callee = edges[node][edge++];
+                if (callee == node) {
+                    result[node] = true;
+                } else if (index[callee] == UNVISITED) {
+                    frames.push_back(std::make_pair(callee, 0));
+                } else if (onStack[callee]) {
+                    lowLink[node] = std::min(lowLink[node], index[callee]);
+                }
+                continue;
+            }
+            
+            if (lowLink[node] == index[node]) {
+                size_t first = stack.size();
+                do {
+                    --first;
+                } while (stack[first] != node);
+                bool cycle = stack.size() - first > 1;
+                for (size_t i = first; i < stack.size(); ++i) {
+                    onStack[stack[i]] = false;
+                    result[stack[i]] = result[stack[i]] || cycle;
+                }
+                stack.resize(first);
+            }
+            frames.pop_back();
+            if (!frames.empty()) {
+                size_t parent = frames.back().first;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+            }
+        }
+    }
+    return result;
+}
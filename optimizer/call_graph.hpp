@@ -0,0 +1,33 @@
+#ifndef CALL_GRAPH_HPP
+#define CALL_GRAPH_HPP
+
+#include "../parser/parser.hpp"
+
+// Calls between the functions of a program. Node 0 is the top-level code,
+// node i > 0 the i-th function definition in source order. Calls to print and
+// to unknown names are not edges.
+class CallGraph {
+private:
+    std::vector<const FunctionDefNode*> nodes;  // nodes[0] == nullptr
+    std::vector<std::vector<size_t>> edges;     // sorted, without duplicates
+    
+    void collectCalls(const std::vector<std::unique_ptr<ASTNode>>& body,
+                      const std::vector<size_t>& indexBySymbol, std::vector<size_t>& callees);
+    
+public:
+    static const size_t TOP_LEVEL = 0;
+    
+    explicit CallGraph(const std::vector<std::unique_ptr<ASTNode>>& program);
+    
+    size_t size() const { return nodes.size(); }
+    const FunctionDefNode* function(size_t node) const { return nodes[node]; }
+    const std::vector<size_t>& callees(size_t node) const { return edges[node]; }
+    size_t edgeCount() const;
+    
+    // nodes the top-level code can end up calling
+    std::vector<bool> reachable() const;
+    // nodes on a call cycle, self-calls included (Tarjan's SCCs)
+    std::vector<bool> recursive() const;
+};
+
+#endif
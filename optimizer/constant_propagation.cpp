@@ -0,0 +1,543 @@
+#include "constant_propagation.hpp"
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+LatticeValue LatticeValue::constant(const Value& v) {
+    LatticeValue result;
+    result.kind = CONSTANT;
+    result.value = v;
+    return result;
+}
+
+LatticeValue LatticeValue::overdefined() {
+    LatticeValue result;
+    result.kind = OVERDEFINED;
+    return result;
+}
+
+static bool sameValue(const Value& a, const Value& b) {
+    if (a.type() != b.type()) {
+        return false;
+    }
+    // compared as numbers so that 0.0 and -0.0 still match
+    if (a.type() == ValueType::FLOAT) {
+        return a.floatValue() == b.floatValue();
+    }
+    return a.identical(b);
+}
+
+bool LatticeValue::operator==(const LatticeValue& other) const {
+    if (kind != other.kind) {
+        return false;
+    }
+    return kind != CONSTANT || sameValue(value, other.value);
+}
+
+bool ConstState::operator==(const ConstState& other) const {
+    return reachable == other.reachable && vars == other.vars;
+}
+
+static LatticeValue meet(const LatticeValue& a, const LatticeValue& b) {
+    if (a.kind == LatticeValue::UNDEF) return b;
+    if (b.kind == LatticeValue::UNDEF) return a;
+    if (a == b) return a;
+    return LatticeValue::overdefined();
+}
+
+// join point of two paths; a variable known on one path only is overdefined
+static ConstState meet(const ConstState& a, const ConstState& b) {
+    if (!a.reachable) return b;
+    if (!b.reachable) return a;
+    
+    ConstState result;
+    for (const auto& entry : a.vars) {
+        auto it = b.vars.find(entry.first);
+        result.vars[entry.first] = it == b.vars.end()
+            ? LatticeValue::overdefined()
+            : meet(entry.second, it->second);
+    }
+    for (const auto& entry : b.vars) {
+        if (!a.vars.count(entry.first)) {
+            result.vars[entry.first] = LatticeValue::overdefined();
+        }
+    }
+    return result;
+}
+
+static bool isBoolLiteral(const IdentifierNode* ident) {
+    return ident->name == SYM_TRUE || ident->name == SYM_FALSE;
+}
+
+static bool literalValue(const ASTNode* node, Value& out) {
+    if (auto number = dynamic_cast<const NumberNode*>(node)) {
+        out = parseNumberLiteral(number->value);
+        return true;
+    }
+    if (auto str = dynamic_cast<const StringNode*>(node)) {
+        out = Value::makeString(str->value);
+        return true;
+    }
+    if (auto ident = dynamic_cast<const IdentifierNode*>(node)) {
+        if (isBoolLiteral(ident)) {
+            out = Value::makeBool(ident->name == SYM_TRUE);
+            return true;
+        }
+    }
+    return false;
+}
+
+// literal node for a value, nullptr if the value has no exact literal form
+static std::unique_ptr<ASTNode> makeLiteral(const Value& value) {
+    switch (value.type()) {
+        case ValueType::INT:
+            return std::unique_ptr<ASTNode>(new NumberNode(std::to_string(value.intValue())));
+        case ValueType::FLOAT: {
+            std::ostringstream out;
+            out << std::setprecision(17) << value.floatValue();
+            std::string text = out.str();
+            if (text.find_first_not_of("-0123456789") == std::string::npos) {
+                text += ".0";
+            }
+            if (text.find_first_not_of("-0123456789.") != std::string::npos ||
+                floatLiteralValue(text) != value.floatValue()) {
+                return nullptr;  // inf, nan, exponent form
+            }
+            return std::unique_ptr<ASTNode>(new NumberNode(text));
+        }
+        case ValueType::STRING:
+            return std::unique_ptr<ASTNode>(new StringNode(value.toString()));
+        case ValueType::BOOL:
+            return std::unique_ptr<ASTNode>(new IdentifierNode(value.boolValue() ? SYM_TRUE : SYM_FALSE));
+        case ValueType::NONE:
+            break;
+    }
+    return nullptr;
+}
+
+static void addUses(const ASTNode* expr, std::set<SymbolId>& live) {
+    if (auto ident = dynamic_cast<const IdentifierNode*>(expr)) {
+        if (!isBoolLiteral(ident)) {
+            live.insert(ident->name);
+        }
+    } else if (auto binary = dynamic_cast<const BinaryOpNode*>(expr)) {
+        addUses(binary->left.get(), live);
+        addUses(binary->right.get(), live);
+    } else if (auto call = dynamic_cast<const FunctionCallNode*>(expr)) {
+        for (const auto& arg : call->arguments) {
+            addUses(arg.get(), live);
+        }
+    } else if (auto conversion = dynamic_cast<const IntToFloatNode*>(expr)) {
+        addUses(conversion->operand.get(), live);
+    }
+}
+
+static void collectReferences(StatementList& body, std::set<SymbolId>& names) {
+    for (auto& stmt : body) {
+        if (auto assign = dynamic_cast<AssignmentNode*>(stmt.get())) {
+            names.insert(assign->name);
+        } else if (dynamic_cast<BinaryOpNode*>(stmt.get())) {
+            addUses(stmt.get(), names);  // an expression statement that may fail
+        }
+        forEachExprSlot(stmt.get(), [&](std::unique_ptr<ASTNode>& slot) {
+            addUses(slot.get(), names);
+        });
+        forEachBody(stmt.get(), [&](StatementList& nested) {
+            collectReferences(nested, names);
+        });
+    }
+}
+
+int countStatements(const StatementList& body) {
+    int count = 0;
+    for (const auto& stmt : body) {
+        count++;
+        forEachBody(stmt.get(), [&](StatementList& nested) {
+            count += countStatements(nested);
+        });
+    }
+    return count;
+}
+
+ConstPropStats ConstantPropagator::run(StatementList& program) {
+    stats = ConstPropStats();
+    exprValues.clear();
+    reached.clear();
+    stats.statementsBefore = countStatements(program);
+    
+    ConstState state;
+    analyzeBody(program, state);
+    rewriteBody(program);
+    
+    // nothing is read after the program ends
+    std::set<SymbolId> live;
+    eliminateDeadStores(program, live, true);
+    while (removeUnusedDeclarations(program)) {
+    }
+    
+    stats.statementsAfter = countStatements(program);
+    return stats;
+}
+
+void ConstantPropagator::record(const ASTNode* node, const LatticeValue& value) {
+    auto it = exprValues.find(node);
+    if (it == exprValues.end()) {
+        exprValues[node] = value;
+    } else {
+        it->second = meet(it->second, value);
+    }
+}
+
+void ConstantPropagator::analyzeBody(const StatementList& body, ConstState& state) {
+    for (const auto& stmt : body) {
+        analyzeStatement(stmt.get(), state);
+    }
+}
+
+void ConstantPropagator::analyzeStatement(const ASTNode* stmt, ConstState& state) {
+    if (!state.reachable) {
+        return;
+    }
+    reached.insert(stmt);
+    
+    if (auto decl = dynamic_cast<const VarDeclarationNode*>(stmt)) {
+        state.vars[decl->name] = decl->initializer
+            ? evaluate(decl->initializer.get(), state)
+            : LatticeValue::constant(Value::defaultFor(decl->type));
+        return;
+    }
+    
+    if (auto assign = dynamic_cast<const AssignmentNode*>(stmt)) {
+        state.vars[assign->name] = evaluate(assign->value.get(), state);
+        return;
+    }
+    
+    if (auto ifNode = dynamic_cast<const IfNode*>(stmt)) {
+        LatticeValue condition = evaluate(ifNode->condition.get(), state);
+        record(ifNode, condition);
+        
+        // only the taken branch is analyzed when the condition is known
+        if (condition.kind == LatticeValue::CONSTANT) {
+            analyzeBody(condition.value.isTruthy() ? ifNode->thenBody : ifNode->elseBody, state);
+            return;
+        }
+        ConstState thenState = state;
+        ConstState elseState = state;
+        analyzeBody(ifNode->thenBody, thenState);
+        analyzeBody(ifNode->elseBody, elseState);
+        state = meet(thenState, elseState);
+        return;
+    }
+    
+    if (auto whileNode = dynamic_cast<const WhileNode*>(stmt)) {
+        // iterate the loop header state down to a fixpoint
+        ConstState head = state;
+        for (;;) {
+            LatticeValue condition = evaluate(whileNode->condition.get(), head);
+            record(whileNode, condition);
+            if (condition.kind == LatticeValue::CONSTANT && !condition.value.isTruthy()) {
+                state = head;
+                return;
+            }
+            
+            ConstState bodyState = head;
+            analyzeBody(whileNode->body, bodyState);
+            ConstState next = meet(state, bodyState);
+            if (next == head) {
+                // while (true) without a way out never falls through
+                state = head;
+                state.reachable = condition.kind != LatticeValue::CONSTANT;
+                return;
+            }
+            head = next;
+        }
+    }
+    
+    if (auto block = dynamic_cast<const BlockNode*>(stmt)) {
+        analyzeBody(block->statements, state);
+        return;
+    }
+    
+    if (auto ret = dynamic_cast<const ReturnNode*>(stmt)) {
+        if (ret->value) {
+            evaluate(ret->value.get(), state);
+        }
+        state.reachable = false;
+        return;
+    }
+    
+    // function bodies are separate units, see program_passes.hpp
+    if (dynamic_cast<const FunctionDefNode*>(stmt)) {
+        return;
+    }
+    
+    evaluate(stmt, state);
+}
+
+LatticeValue ConstantPropagator::evaluate(const ASTNode* expr, const ConstState& state) {
+    Value literal;
+    if (literalValue(expr, literal)) {
+        return LatticeValue::constant(literal);
+    }
+    
+    if (auto ident = dynamic_cast<const IdentifierNode*>(expr)) {
+        auto it = state.vars.find(ident->name);
+        LatticeValue value = it == state.vars.end() ? LatticeValue::overdefined() : it->second;
+        record(ident, value);
+        return value;
+    }
+    
+    if (auto binary = dynamic_cast<const BinaryOpNode*>(expr)) {
+        LatticeValue left = evaluate(binary->left.get(), state);
+        LatticeValue right = evaluate(binary->right.get(), state);
+        if (left.kind != LatticeValue::CONSTANT || right.kind != LatticeValue::CONSTANT) {
+            return LatticeValue::overdefined();
+        }
+        try {
+            return LatticeValue::constant(applyBinaryOp(binary->op, left.value, right.value));
+        } catch (const std::runtime_error&) {
+            // keep the error for run time
+            return LatticeValue::overdefined();
+        }
+    }
+    
+    if (auto conversion = dynamic_cast<const IntToFloatNode*>(expr)) {
+        LatticeValue operand = evaluate(conversion->operand.get(), state);
+        if (operand.kind != LatticeValue::CONSTANT) {
+            return LatticeValue::overdefined();
+        }
+        return LatticeValue::constant(Value::makeFloat(operand.value.asFloat()));
+    }
+    
+    if (auto call = dynamic_cast<const FunctionCallNode*>(expr)) {
+        for (const auto& arg : call->arguments) {
+            evaluate(arg.get(), state);
+        }
+    }
+    return LatticeValue::overdefined();
+}
+
+void ConstantPropagator::rewriteBody(StatementList& body) {
+    for (size_t i = 0; i < body.size(); ) {
+        ASTNode* stmt = body[i].get();
+        // callable from anywhere, even after a loop that never ends
+        if (dynamic_cast<FunctionDefNode*>(stmt)) {
+            ++i;
+            continue;
+        }
+        if (!reached.count(stmt)) {
+            stats.unreachableRemoved++;
+            body.erase(body.begin() + i);
+            continue;
+        }
+        
+        auto it = exprValues.find(stmt);
+        bool constant = it != exprValues.end() && it->second.kind == LatticeValue::CONSTANT;
+        
+        if (auto ifNode = dynamic_cast<IfNode*>(stmt)) {
+            if (constant) {
+                // replace the if by the statements of the taken branch
+                StatementList taken = std::move(it->second.value.isTruthy()
+                                                ? ifNode->thenBody : ifNode->elseBody);
+                rewriteBody(taken);
+                stats.branchesResolved++;
+                body.erase(body.begin() + i);
+                for (size_t k = 0; k < taken.size(); ++k) {
+                    body.insert(body.begin() + i + k, std::move(taken[k]));
+                }
+                i += taken.size();
+                continue;
+            }
+        } else if (dynamic_cast<WhileNode*>(stmt) && constant && !it->second.value.isTruthy()) {
+            stats.branchesResolved++;
+            body.erase(body.begin() + i);
+            continue;
+        }
+        
+        forEachExprSlot(stmt, [&](std::unique_ptr<ASTNode>& slot) {
+            rewriteExpr(slot);
+        });
+        forEachBody(stmt, [&](StatementList& nested) {
+            rewriteBody(nested);
+        });
+        ++i;
+    }
+}
+
+void ConstantPropagator::rewriteExpr(std::unique_ptr<ASTNode>& slot) {
+    forEachSubExprSlot(slot, [&](std::unique_ptr<ASTNode>& node) {
+        if (auto ident = dynamic_cast<IdentifierNode*>(node.get())) {
+            // true/false may be nodes created here, at the address of a freed read
+            if (isBoolLiteral(ident)) {
+                return;
+            }
+            auto it = exprValues.find(ident);
+            if (it == exprValues.end() || it->second.kind != LatticeValue::CONSTANT) {
+                return;
+            }
+            auto literal = makeLiteral(it->second.value);
+            if (literal) {
+                literal->copyPosition(*node);
+                node = std::move(literal);
+                stats.propagated++;
+            }
+            return;
+        }
+        
+        if (auto binary = dynamic_cast<BinaryOpNode*>(node.get())) {
+            Value left, right;
+            if (!literalValue(binary->left.get(), left) || !literalValue(binary->right.get(), right)) {
+                return;
+            }
+            try {
+                auto literal = makeLiteral(applyBinaryOp(binary->op, left, right));
+                if (literal) {
+                    literal->copyPosition(*node);
+                    node = std::move(literal);
+                    stats.folded++;
+                }
+            } catch (const std::runtime_error&) {
+            }
+            return;
+        }
+        
+        if (auto conversion = dynamic_cast<IntToFloatNode*>(node.get())) {
+            Value operand;
+            if (!literalValue(conversion->operand.get(), operand)) {
+                return;
+            }
+            auto literal = makeLiteral(Value::makeFloat(operand.asFloat()));
+            if (literal) {
+                literal->copyPosition(*node);
+                node = std::move(literal);
+                stats.folded++;
+            }
+        }
+    });
+}
+
+// backward liveness; with apply == false only live is computed
+void ConstantPropagator::eliminateDeadStores(StatementList& body, std::set<SymbolId>& live,
+                                             bool apply) {
+    for (size_t i = body.size(); i-- > 0; ) {
+        ASTNode* stmt = body[i].get();
+        
+        if (auto assign = dynamic_cast<AssignmentNode*>(stmt)) {
+            if (!live.count(assign->name) && !hasSideEffects(assign->value.get())) {
+                if (apply) {
+                    stats.deadStoresRemoved++;
+                    body.erase(body.begin() + i);
+                }
+                continue;
+            }
+            live.erase(assign->name);
+            addUses(assign->value.get(), live);
+            continue;
+        }
+        
+        if (auto decl = dynamic_cast<VarDeclarationNode*>(stmt)) {
+            if (decl->initializer && !live.count(decl->name) && !hasSideEffects(decl->initializer.get())) {
+                if (apply) {
+                    stats.deadStoresRemoved++;
+                    decl->initializer.reset();
+                }
+                continue;
+            }
+            live.erase(decl->name);
+            if (decl->initializer) {
+                addUses(decl->initializer.get(), live);
+            }
+            continue;
+        }
+        
+        if (auto ifNode = dynamic_cast<IfNode*>(stmt)) {
+            std::set<SymbolId> thenLive = live;
+            std::set<SymbolId> elseLive = live;
+            eliminateDeadStores(ifNode->thenBody, thenLive, apply);
+            eliminateDeadStores(ifNode->elseBody, elseLive, apply);
+            live = thenLive;
+            live.insert(elseLive.begin(), elseLive.end());
+            addUses(ifNode->condition.get(), live);
+            
+            if (apply && ifNode->thenBody.empty() && ifNode->elseBody.empty() &&
+                !hasSideEffects(ifNode->condition.get())) {
+                body.erase(body.begin() + i);
+            }
+            continue;
+        }
+        
+        if (auto whileNode = dynamic_cast<WhileNode*>(stmt)) {
+            std::set<SymbolId> head = live;
+            addUses(whileNode->condition.get(), head);
+            for (;;) {
+                std::set<SymbolId> next = head;
+                eliminateDeadStores(whileNode->body, next, false);
+                next.insert(head.begin(), head.end());
+                if (next == head) {
+                    break;
+                }
+                head = next;
+            }
+            if (apply) {
+                std::set<SymbolId> bodyLive = head;
+                eliminateDeadStores(whileNode->body, bodyLive, true);
+            }
+            live = head;
+            continue;
+        }
+        
+        if (auto block = dynamic_cast<BlockNode*>(stmt)) {
+            eliminateDeadStores(block->statements, live, apply);
+            continue;
+        }
+        
+        // nothing of the function is read after a return but its value
+        if (auto ret = dynamic_cast<ReturnNode*>(stmt)) {
+            live.clear();
+            if (ret->value) {
+                addUses(ret->value.get(), live);
+            }
+            continue;
+        }
+        
+        if (dynamic_cast<FunctionDefNode*>(stmt)) {
+            continue;
+        }
+        
+        // expression statement: only calls and possible errors have an effect
+        if (!hasSideEffects(stmt)) {
+            if (apply) {
+                stats.deadStoresRemoved++;
+                body.erase(body.begin() + i);
+            }
+            continue;
+        }
+        addUses(stmt, live);
+    }
+}
+
+static bool removeDeclarationsOf(StatementList& body, const std::set<SymbolId>& used,
+                                 int& removed) {
+    bool changed = false;
+    for (size_t i = 0; i < body.size(); ) {
+        auto decl = dynamic_cast<VarDeclarationNode*>(body[i].get());
+        if (decl && !used.count(decl->name) &&
+            (!decl->initializer || !hasSideEffects(decl->initializer.get()))) {
+            body.erase(body.begin() + i);
+            removed++;
+            changed = true;
+            continue;
+        }
+        forEachBody(body[i].get(), [&](StatementList& nested) {
+            changed |= removeDeclarationsOf(nested, used, removed);
+        });
+        ++i;
+    }
+    return changed;
+}
+
+bool ConstantPropagator::removeUnusedDeclarations(StatementList& program) {
+    std::set<SymbolId> used;
+    collectReferences(program, used);
+    return removeDeclarationsOf(program, used, stats.declarationsRemoved);
+}
@@ -0,0 +1,79 @@
+#ifndef CONSTANT_PROPAGATION_HPP
+#define CONSTANT_PROPAGATION_HPP
+
+#include "ast_utils.hpp"
+#include "../interpreter/value.hpp"
+#include <map>
+#include <set>
+
+// SCCP lattice: UNDEF (no value yet) > CONSTANT > OVERDEFINED
+struct LatticeValue {
+    enum Kind { UNDEF, CONSTANT, OVERDEFINED };
+    Kind kind;
+    Value value;
+    
+    LatticeValue() : kind(UNDEF) {}
+    static LatticeValue constant(const Value& v);
+    static LatticeValue overdefined();
+    
+    bool operator==(const LatticeValue& other) const;
+    bool operator!=(const LatticeValue& other) const { return !(*this == other); }
+};
+
+// abstract program state at one point of the control flow
+struct ConstState {
+    bool reachable;
+    std::map<SymbolId, LatticeValue> vars;  // absent = not declared on this path
+    
+    ConstState() : reachable(true) {}
+    bool operator==(const ConstState& other) const;
+};
+
+struct ConstPropStats {
+    int propagated;          // variable reads replaced by literals
+    int folded;              // binary operations evaluated at compile time
+    int branchesResolved;    // if/while with a constant condition
+    int unreachableRemoved;  // statements no path reaches
+    int deadStoresRemoved;   // assignments/initializers whose value is never read
+    int declarationsRemoved; // declarations of variables nobody uses
+    int statementsBefore;
+    int statementsAfter;
+    
+    ConstPropStats()
+        : propagated(0), folded(0), branchesResolved(0), unreachableRemoved(0),
+          deadStoresRemoved(0), declarationsRemoved(0),
+          statementsBefore(0), statementsAfter(0) {}
+};
+
+// Sparse conditional constant propagation over the structured control flow of
+// if/while, followed by dead-store and unused-declaration removal. run() takes
+// one unit, the top-level code or a function body: definitions found in it are
+// left alone, and calls only produce unknown values since a function cannot
+// touch the caller's variables.
+class ConstantPropagator {
+private:
+    std::map<const ASTNode*, LatticeValue> exprValues;  // identifier reads, if/while conditions
+    std::set<const ASTNode*> reached;
+    ConstPropStats stats;
+    
+    // analysis
+    void analyzeBody(const StatementList& body, ConstState& state);
+    void analyzeStatement(const ASTNode* stmt, ConstState& state);
+    LatticeValue evaluate(const ASTNode* expr, const ConstState& state);
+    void record(const ASTNode* node, const LatticeValue& value);
+    
+    // rewriting
+    void rewriteBody(StatementList& body);
+    void rewriteExpr(std::unique_ptr<ASTNode>& slot);
+    
+    // dead code
+    void eliminateDeadStores(StatementList& body, std::set<SymbolId>& live, bool apply);
+    bool removeUnusedDeclarations(StatementList& program);
+    
+public:
+    ConstPropStats run(StatementList& program);
+};
+
+int countStatements(const StatementList& body);
+
+#endif
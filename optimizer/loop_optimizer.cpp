@@ -0,0 +1,398 @@
+#include "loop_optimizer.hpp"
+#include <iterator>
+
+static std::unique_ptr<ASTNode> makeIdentifier(SymbolId name) {
+    return std::unique_ptr<ASTNode>(new IdentifierNode(name));
+}
+
+// a read of a temporary standing in for the expression at `replaced`
+static std::unique_ptr<ASTNode> makeIdentifier(SymbolId name, const ASTNode& replaced) {
+    auto node = makeIdentifier(name);
+    node->copyPosition(replaced);
+    return node;
+}
+
+static std::unique_ptr<ASTNode> makeNumber(const std::string& value) {
+    return std::unique_ptr<ASTNode>(new NumberNode(value));
+}
+
+static std::unique_ptr<ASTNode> makeBinary(const std::string& op,
+                                           std::unique_ptr<ASTNode> left,
+                                           std::unique_ptr<ASTNode> right) {
+    return std::unique_ptr<ASTNode>(
+        new BinaryOpNode(op, std::move(left), std::move(right)));
+}
+
+static bool isComparison(const std::string& op) {
+    return op == "==" || op == "!=" || op == "<" || op == ">" ||
+           op == "<=" || op == ">=";
+}
+
+static int32_t literalToInt(const ASTNode* node) {
+    return intLiteralValue(static_cast<const NumberNode*>(node)->value);
+}
+
+static void countWrites(const StatementList& body, std::map<SymbolId, int>& writes) {
+    for (const auto& stmt : body) {
+        if (auto decl = dynamic_cast<const VarDeclarationNode*>(stmt.get())) {
+            writes[decl->name]++;
+        } else if (auto assign = dynamic_cast<const AssignmentNode*>(stmt.get())) {
+            writes[assign->name]++;
+        }
+        forEachBody(stmt.get(), [&](StatementList& nested) {
+            countWrites(nested, writes);
+        });
+    }
+}
+
+LoopOptimizer::LoopOptimizer() : tempCounter(0) {}
+
+LoopOptStats LoopOptimizer::run(StatementList& program) {
+    stats = LoopOptStats();
+    varTypes.clear();
+    collectTypes(program);
+    std::set<SymbolId> declared;
+    optimizeBody(program, declared, 0);
+    return stats;
+}
+
+LoopOptStats LoopOptimizer::run(FunctionDefNode& function) {
+    stats = LoopOptStats();
+    varTypes.clear();
+    std::set<SymbolId> declared;
+    for (const auto& parameter : function.parameters) {
+        varTypes[parameter.name] = parameter.type;
+        declared.insert(parameter.name);
+    }
+    collectTypes(function.body);
+    optimizeBody(function.body, declared, 0);
+    return stats;
+}
+
+void LoopOptimizer::collectTypes(const StatementList& body) {
+    for (const auto& stmt : body) {
+        if (auto decl = dynamic_cast<const VarDeclarationNode*>(stmt.get())) {
+            auto it = varTypes.find(decl->name);
+            if (it == varTypes.end()) {
+                varTypes[decl->name] = decl->type;
+            } else if (it->second != decl->type) {
+                it->second = "";
+            }
+        }
+        forEachBody(stmt.get(), [&](StatementList& nested) {
+            collectTypes(nested);
+        });
+    }
+}
+
+// declared = variables whose declaration has certainly executed at this point;
+// names added here are removed again on exit
+void LoopOptimizer::optimizeBody(StatementList& body, std::set<SymbolId>& declared, int depth) {
+    std::vector<SymbolId> added;
+    
+    for (size_t i = 0; i < body.size(); ++i) {
+        if (dynamic_cast<WhileNode*>(body[i].get())) {
+            size_t inserted = optimizeLoop(body, i, declared, depth);
+            for (size_t k = i; k < i + inserted; ++k) {
+                SymbolId name = static_cast<VarDeclarationNode*>(body[k].get())->name;
+                if (declared.insert(name).second) {
+                    added.push_back(name);
+                }
+            }
+            i += inserted;
+            continue;
+        }
+        
+        forEachBody(body[i].get(), [&](StatementList& nested) {
+            optimizeBody(nested, declared, depth);
+        });
+        
+        if (auto decl = dynamic_cast<VarDeclarationNode*>(body[i].get())) {
+            if (declared.insert(decl->name).second) {
+                added.push_back(decl->name);
+            }
+        }
+    }
+    
+    for (SymbolId name : added) {
+        declared.erase(name);
+    }
+}
+
+// returns the number of statements inserted before the loop
+size_t LoopOptimizer::optimizeLoop(StatementList& body, size_t index,
+                                   std::set<SymbolId>& declared, int depth) {
+    WhileNode* whileNode = static_cast<WhileNode*>(body[index].get());
+    
+    // inner loops first, their preheaders end up in this loop's body
+    optimizeBody(whileNode->body, declared, depth + 1);
+    
+    LoopInfo loop = analyzeLoop(whileNode, depth);
+    stats.loops++;
+    stats.inductionVariables += loop.inductionVariables.size();
+    
+    StatementList preheader;
+    if (reduceStrength(loop, preheader, declared) > 0) {
+        loop = analyzeLoop(whileNode, depth);  // the new temporaries are written in the body
+    }
+    hoistInvariants(loop, preheader, declared);
+    
+    size_t inserted = preheader.size();
+    body.insert(body.begin() + index,
+                std::make_move_iterator(preheader.begin()),
+                std::make_move_iterator(preheader.end()));
+    return inserted;
+}
+
+LoopInfo LoopOptimizer::analyzeLoop(WhileNode* whileNode, int depth) {
+    LoopInfo loop;
+    loop.node = whileNode;
+    loop.depth = depth;
+    countWrites(whileNode->body, loop.writes);
+    
+    // i = i + c, i = c + i, i = i - c directly in the body, written nowhere else
+    for (const auto& stmt : whileNode->body) {
+        auto assign = dynamic_cast<AssignmentNode*>(stmt.get());
+        if (!assign || loop.writes[assign->name] != 1 || varTypes[assign->name] != "int") {
+            continue;
+        }
+        auto binary = dynamic_cast<const BinaryOpNode*>(assign->value.get());
+        if (!binary || (binary->op != "+" && binary->op != "-")) {
+            continue;
+        }
+        
+        auto leftIdent = dynamic_cast<const IdentifierNode*>(binary->left.get());
+        auto rightIdent = dynamic_cast<const IdentifierNode*>(binary->right.get());
+        int32_t step;
+        if (leftIdent && leftIdent->name == assign->name && isIntLiteral(binary->right.get())) {
+            step = literalToInt(binary->right.get());
+            if (binary->op == "-") {
+                step = static_cast<int32_t>(0u - static_cast<uint32_t>(step));
+            }
+        } else if (binary->op == "+" && rightIdent && rightIdent->name == assign->name &&
+                   isIntLiteral(binary->left.get())) {
+            step = literalToInt(binary->left.get());
+        } else {
+            continue;
+        }
+        
+        InductionVariable iv;
+        iv.name = assign->name;
+        iv.step = step;
+        iv.update = assign;
+        loop.inductionVariables.push_back(iv);
+    }
+    
+    return loop;
+}
+
+// i * c  ==>  t, with "int t = i * c;" before the loop and "t = t + step*c;"
+// right after the update of i
+size_t LoopOptimizer::reduceStrength(LoopInfo& loop, StatementList& preheader,
+                                     const std::set<SymbolId>& declared) {
+    std::map<SymbolId, const InductionVariable*> ivs;
+    for (const auto& iv : loop.inductionVariables) {
+        if (declared.count(iv.name)) {
+            ivs[iv.name] = &iv;
+        }
+    }
+    if (ivs.empty()) {
+        return 0;
+    }
+    
+    struct Reduction {
+        const InductionVariable* iv;
+        int32_t factor;
+        SymbolId temp;
+    };
+    std::map<std::pair<SymbolId, int32_t>, Reduction> reductions;
+    
+    SlotCallback reduce = [&](std::unique_ptr<ASTNode>& slot) {
+        auto binary = dynamic_cast<BinaryOpNode*>(slot.get());
+        if (!binary || binary->op != "*") {
+            return;
+        }
+        auto ident = dynamic_cast<IdentifierNode*>(binary->left.get());
+        const ASTNode* factorNode = binary->right.get();
+        if (!ident) {
+            ident = dynamic_cast<IdentifierNode*>(binary->right.get());
+            factorNode = binary->left.get();
+        }
+        if (!ident || !ivs.count(ident->name) || !isIntLiteral(factorNode)) {
+            return;
+        }
+        
+        int32_t factor = literalToInt(factorNode);
+        auto key = std::make_pair(ident->name, factor);
+        auto it = reductions.find(key);
+        if (it == reductions.end()) {
+            Reduction reduction;
+            reduction.iv = ivs[ident->name];
+            reduction.factor = factor;
+            reduction.temp = newTemp("__sr");
+            it = reductions.insert(std::make_pair(key, reduction)).first;
+        }
+        slot = makeIdentifier(it->second.temp, *slot);
+        stats.strengthReduced++;
+    };
+    
+    forEachSubExprSlot(loop.node->condition, reduce);
+    for (auto& stmt : loop.node->body) {
+        forEachExprSlotDeep(stmt.get(), [&](std::unique_ptr<ASTNode>& slot) {
+            forEachSubExprSlot(slot, reduce);
+        });
+    }
+    
+    StatementList& body = loop.node->body;
+    for (auto& entry : reductions) {
+        const Reduction& reduction = entry.second;
+        varTypes[reduction.temp] = "int";
+        
+        preheader.push_back(std::unique_ptr<ASTNode>(new VarDeclarationNode(
+            "int", reduction.temp,
+            makeBinary("*", makeIdentifier(reduction.iv->name),
+                       makeNumber(std::to_string(reduction.factor))))));
+        // runs where the loop starts, as far as the profiler is concerned
+        preheader.back()->copyPosition(*loop.node);
+        
+        // same wrap-around arithmetic as the runtime
+        uint32_t delta = static_cast<uint32_t>(reduction.iv->step) *
+                         static_cast<uint32_t>(reduction.factor);
+        std::string op = "+";
+        if (static_cast<int32_t>(delta) < 0) {
+            op = "-";
+            delta = 0u - delta;
+        }
+        
+        for (size_t i = 0; i < body.size(); ++i) {
+            if (body[i].get() == reduction.iv->update) {
+                body.insert(body.begin() + i + 1, std::unique_ptr<ASTNode>(new AssignmentNode(
+                    reduction.temp,
+                    makeBinary(op, makeIdentifier(reduction.temp),
+                               makeNumber(std::to_string(delta))))));
+                body[i + 1]->copyPosition(*body[i]);
+                break;
+            }
+        }
+    }
+    
+    return reductions.size();
+}
+
+// moves maximal invariant subexpressions into "T __licmN = expr;" before the loop,
+// identical expressions share one temporary
+size_t LoopOptimizer::hoistInvariants(LoopInfo& loop, StatementList& preheader,
+                                      const std::set<SymbolId>& declared) {
+    std::map<std::string, SymbolId> hoisted;  // expression text -> temporary
+    
+    SlotCallback visit = [&](std::unique_ptr<ASTNode>& slot) {
+        if (!slot) {
+            return;
+        }
+        if (dynamic_cast<BinaryOpNode*>(slot.get()) && isInvariant(slot.get(), loop, declared)) {
+            std::string type = inferType(slot.get());
+            if (!type.empty()) {
+                std::string key = slot->toString();
+                auto it = hoisted.find(key);
+                bool first = it == hoisted.end();
+                if (first) {
+                    SymbolId temp = newTemp("__licm");
+                    varTypes[temp] = type;
+                    it = hoisted.insert(std::make_pair(key, temp)).first;
+                }
+                auto use = makeIdentifier(it->second, *slot);
+                if (first) {
+                    preheader.push_back(std::unique_ptr<ASTNode>(
+                        new VarDeclarationNode(type, it->second, std::move(slot))));
+                    preheader.back()->copyPosition(*loop.node);
+                }
+                slot = std::move(use);
+                stats.hoisted++;
+                return;
+            }
+        }
+        forEachChildSlot(slot.get(), visit);
+    };
+    
+    visit(loop.node->condition);
+    for (auto& stmt : loop.node->body) {
+        forEachExprSlotDeep(stmt.get(), visit);
+    }
+    
+    return hoisted.size();
+}
+
+// pure, cannot throw and reads nothing the loop writes: safe to evaluate
+// once before the loop even if the body never runs
+bool LoopOptimizer::isInvariant(const ASTNode* expr, const LoopInfo& loop,
+                                const std::set<SymbolId>& declared) {
+    if (dynamic_cast<const NumberNode*>(expr) || dynamic_cast<const StringNode*>(expr)) {
+        return true;
+    }
+    if (auto ident = dynamic_cast<const IdentifierNode*>(expr)) {
+        if (ident->name == SYM_TRUE || ident->name == SYM_FALSE) {
+            return true;
+        }
+        return !loop.writes.count(ident->name) && declared.count(ident->name);
+    }
+    if (auto binary = dynamic_cast<const BinaryOpNode*>(expr)) {
+        if (binary->op == "/" && !isNonZeroLiteral(binary->right.get())) {
+            return false;
+        }
+        return isInvariant(binary->left.get(), loop, declared) &&
+               isInvariant(binary->right.get(), loop, declared);
+    }
+    if (auto conversion = dynamic_cast<const IntToFloatNode*>(expr)) {
+        return isInvariant(conversion->operand.get(), loop, declared);
+    }
+    return false;
+}
+
+// static type of an expression, "" if unknown or ill-typed
+std::string LoopOptimizer::inferType(const ASTNode* expr) {
+    if (auto number = dynamic_cast<const NumberNode*>(expr)) {
+        return number->value.find('.') == std::string::npos ? "int" : "float";
+    }
+    if (dynamic_cast<const StringNode*>(expr)) {
+        return "string";
+    }
+    if (auto ident = dynamic_cast<const IdentifierNode*>(expr)) {
+        if (ident->name == SYM_TRUE || ident->name == SYM_FALSE) {
+            return "bool";
+        }
+        auto it = varTypes.find(ident->name);
+        return it == varTypes.end() ? "" : it->second;
+    }
+    if (auto binary = dynamic_cast<const BinaryOpNode*>(expr)) {
+        std::string left = inferType(binary->left.get());
+        std::string right = inferType(binary->right.get());
+        if (left.empty() || right.empty()) {
+            return "";
+        }
+        bool numeric = (left == "int" || left == "float") && (right == "int" || right == "float");
+        if (isComparison(binary->op)) {
+            if (numeric || left == right) {
+                return (left == "bool" && binary->op != "==" && binary->op != "!=") ? "" : "bool";
+            }
+            return "";
+        }
+        if (numeric) {
+            return (left == "float" || right == "float") ? "float" : "int";
+        }
+        if (left == "string" && right == "string" && binary->op == "+") {
+            return "string";
+        }
+    }
+    if (dynamic_cast<const IntToFloatNode*>(expr)) {
+        return "float";
+    }
+    return "";
+}
+
+SymbolId LoopOptimizer::newTemp(const std::string& prefix) {
+    SymbolId name;
+    do {
+        name = internSymbol(prefix + std::to_string(tempCounter++));
+    } while (varTypes.count(name));
+    return name;
+}
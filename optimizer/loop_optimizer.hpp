@@ -0,0 +1,64 @@
+#ifndef LOOP_OPTIMIZER_HPP
+#define LOOP_OPTIMIZER_HPP
+
+#include "ast_utils.hpp"
+#include <map>
+#include <set>
+
+// basic induction variable: the only write to it in the loop is "i = i +/- step"
+struct InductionVariable {
+    SymbolId name;
+    int32_t step;
+    AssignmentNode* update;
+};
+
+// natural loop built from a WhileNode: header = condition, body = loop body
+struct LoopInfo {
+    WhileNode* node;
+    int depth;
+    std::map<SymbolId, int> writes;  // variable -> number of writes in the body
+    std::vector<InductionVariable> inductionVariables;
+};
+
+struct LoopOptStats {
+    int loops;
+    int inductionVariables;
+    int hoisted;          // loop-invariant expressions moved before the loop
+    int strengthReduced;  // i * c replaced by an additive temporary
+    
+    LoopOptStats() : loops(0), inductionVariables(0), hoisted(0), strengthReduced(0) {}
+};
+
+// Loop-invariant code motion + strength reduction of induction variables.
+// New temporaries are declared right before the loop as "__licmN"/"__srN".
+class LoopOptimizer {
+private:
+    std::map<SymbolId, std::string> varTypes;  // "" when declared with different types
+    int tempCounter;
+    LoopOptStats stats;
+    
+    void collectTypes(const StatementList& body);
+    void optimizeBody(StatementList& body, std::set<SymbolId>& declared, int depth);
+    size_t optimizeLoop(StatementList& body, size_t index,
+                        std::set<SymbolId>& declared, int depth);
+    
+    LoopInfo analyzeLoop(WhileNode* loop, int depth);
+    size_t reduceStrength(LoopInfo& loop, StatementList& preheader,
+                          const std::set<SymbolId>& declared);
+    size_t hoistInvariants(LoopInfo& loop, StatementList& preheader,
+                           const std::set<SymbolId>& declared);
+    
+    bool isInvariant(const ASTNode* expr, const LoopInfo& loop,
+                     const std::set<SymbolId>& declared);
+    std::string inferType(const ASTNode* expr);
+    SymbolId newTemp(const std::string& prefix);
+    
+public:
+    LoopOptimizer();
+    
+    LoopOptStats run(StatementList& program);
+    // a function body, its parameters count as declared variables
+    LoopOptStats run(FunctionDefNode& function);
+};
+
+#endif
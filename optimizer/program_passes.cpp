@@ -0,0 +1,80 @@
+#include "program_passes.hpp"
+#include "call_graph.hpp"
+
+// unit 0 is the top-level code, unit i > 0 the body of functions[i - 1]
+static std::vector<FunctionDefNode*> functionsOf(StatementList& program) {
+    std::vector<FunctionDefNode*> functions;
+    forEachFunction(program, [&](FunctionDefNode& function) {
+        functions.push_back(&function);
+    });
+    return functions;
+}
+
+static void addStats(ConstPropStats& total, const ConstPropStats& unit) {
+    total.propagated += unit.propagated;
+    total.folded += unit.folded;
+    total.branchesResolved += unit.branchesResolved;
+    total.unreachableRemoved += unit.unreachableRemoved;
+    total.deadStoresRemoved += unit.deadStoresRemoved;
+    total.declarationsRemoved += unit.declarationsRemoved;
+    total.statementsBefore += unit.statementsBefore;
+    total.statementsAfter += unit.statementsAfter;
+}
+
+static void addStats(LoopOptStats& total, const LoopOptStats& unit) {
+    total.loops += unit.loops;
+    total.inductionVariables += unit.inductionVariables;
+    total.hoisted += unit.hoisted;
+    total.strengthReduced += unit.strengthReduced;
+}
+
+ConstPropStats propagateConstants(StatementList& program, ThreadPool* pool) {
+    std::vector<FunctionDefNode*> functions = functionsOf(program);
+    // the definitions themselves are counted by the top-level unit
+    std::vector<ConstPropStats> results(functions.size() + 1);
+    parallelFor(pool, results.size(), [&](size_t i) {
+        ConstantPropagator propagator;
+        results[i] = propagator.run(i == 0 ? program : functions[i - 1]->body);
+    });
+    
+    ConstPropStats total;
+    for (const auto& unit : results) {
+        addStats(total, unit);
+    }
+    return total;
+}
+
+LoopOptStats optimizeLoops(StatementList& program, ThreadPool* pool) {
+    std::vector<FunctionDefNode*> functions = functionsOf(program);
+    std::vector<LoopOptStats> results(functions.size() + 1);
+    parallelFor(pool, results.size(), [&](size_t i) {
+        LoopOptimizer optimizer;
+        results[i] = i == 0 ? optimizer.run(program) : optimizer.run(*functions[i - 1]);
+    });
+    
+    LoopOptStats total;
+    for (const auto& unit : results) {
+        addStats(total, unit);
+    }
+    return total;
+}
+
+size_t removeUnreachableFunctions(StatementList& program) {
+    CallGraph graph(program);
+    std::vector<bool> reachable = graph.reachable();
+    
+    // graph nodes follow the definitions in source order
+    StatementList kept;
+    kept.reserve(program.size());
+    size_t node = 0;
+    size_t removed = 0;
+    for (auto& stmt : program) {
+        if (dynamic_cast<FunctionDefNode*>(stmt.get()) && !reachable[++node]) {
+            removed++;
+            continue;
+        }
+        kept.push_back(std::move(stmt));
+    }
+    program.swap(kept);
+    return removed;
+}
@@ -0,0 +1,18 @@
+#ifndef PROGRAM_PASSES_HPP
+#define PROGRAM_PASSES_HPP
+
+#include "constant_propagation.hpp"
+#include "loop_optimizer.hpp"
+#include "../util/thread_pool.hpp"
+
+// Whole-program drivers of the optimizer passes. The top-level code and each
+// function body are independent units (a function sees only its parameters
+// and locals), so the units run in parallel on pool when one is given. Units
+// share nothing but the global interner, which locks. Stats are summed.
+ConstPropStats propagateConstants(StatementList& program, ThreadPool* pool = nullptr);
+LoopOptStats optimizeLoops(StatementList& program, ThreadPool* pool = nullptr);
+
+// drops the functions the top-level code can never call, returns how many
+size_t removeUnreachableFunctions(StatementList& program);
+
+#endif
@@ -1,13 +1,49 @@
 #include "parser.hpp"
+#include <cstdlib>
 #include <sstream>
+#include <stdexcept>
+
+const int Parser::MAX_NESTING;
+const size_t Parser::MAX_EXPRESSION_OPERATORS;
+const size_t Parser::MAX_ERRORS;
+
+namespace {
+
+class NestingGuard {
+private:
+    int& depth;
+    
+public:
+    NestingGuard(int& d) : depth(d) {
+        if (depth >= Parser::MAX_NESTING) {
+            throw std::runtime_error("Слишком глубокая вложенность (больше " +
+                                     std::to_string(Parser::MAX_NESTING) + ")");
+        }
+        ++depth;
+    }
+    ~NestingGuard() { --depth; }
+};
+
+static bool isValueType(const Token& token) {
+    return token.type == TokenType::KEYWORD &&
+           (token.value == "int" || token.value == "float" ||
+            token.value == "string" || token.value == "bool");
+}
+
+}
 
 Parser::Parser(const std::vector<Token>& inputTokens) 
-    : tokens(inputTokens), position(0) {
+    : tokens(inputTokens), position(0), errors(&std::cerr),
+      nesting(0), expressionOperators(0), syntaxErrors(0) {
     if (!tokens.empty()) {
         currentToken = tokens[position];
     }
 }
 
+void Parser::setErrorStream(std::ostream& stream) {
+    errors = &stream;
+}
+
 void Parser::advance() {
     position++;
     if (position < tokens.size()) {
@@ -33,10 +69,10 @@ bool Parser::match(const std::string& value) {
 
 void Parser::expect(TokenType type, const std::string& errorMessage) {
     if (currentToken.type != type) {
-        std::cerr << "Ошибка в строке " << currentToken.line 
+        *errors << "Ошибка в строке " << currentToken.line 
                   << ", позиция " << currentToken.column << ": ";
-        std::cerr << errorMessage << std::endl;
-        std::cerr << "Ожидался " << static_cast<int>(type) 
+        *errors << errorMessage << std::endl;
+        *errors << "Ожидался " << static_cast<int>(type) 
                   << ", получен " << static_cast<int>(currentToken.type) 
                   << " (" << currentToken.value << ")" << std::endl;
         throw std::runtime_error(errorMessage);
@@ -45,10 +81,10 @@ void Parser::expect(TokenType type, const std::string& errorMessage) {
 
 void Parser::expect(const std::string& value, const std::string& errorMessage) {
     if (currentToken.value != value) {
-        std::cerr << "Ошибка в строке " << currentToken.line 
+        *errors << "Ошибка в строке " << currentToken.line 
                   << ", позиция " << currentToken.column << ": ";
-        std::cerr << errorMessage << std::endl;
-        std::cerr << "Ожидался '" << value << "', получен '" 
+        *errors << errorMessage << std::endl;
+        *errors << "Ожидался '" << value << "', получен '" 
                   << currentToken.value << "'" << std::endl;
         throw std::runtime_error(errorMessage);
     }
@@ -58,6 +94,7 @@ void Parser::expect(const std::string& value, const std::string& errorMessage) {
 
 std::vector<std::unique_ptr<ASTNode>> Parser::parse() {
     std::vector<std::unique_ptr<ASTNode>> program;
+    syntaxErrors = 0;
     
     while (currentToken.type != TokenType::END) {
         try {
@@ -66,7 +103,11 @@ std::vector<std::unique_ptr<ASTNode>> Parser::parse() {
                 program.push_back(std::move(statement));
             }
         } catch (const std::exception& e) {
-            std::cerr << "Ошибка парсинга: " << e.what() << std::endl;
+            *errors << "Ошибка парсинга: " << e.what() << std::endl;
+            if (++syntaxErrors >= MAX_ERRORS) {
+                *errors << "Слишком много ошибок, разбор остановлен" << std::endl;
+                break;
+            }
             while (currentToken.type != TokenType::END && 
                    currentToken.type != TokenType::SEMICOLN) {
                 advance();
@@ -80,7 +121,24 @@ std::vector<std::unique_ptr<ASTNode>> Parser::parse() {
     return program;
 }
 
+void Parser::countOperator() {
+    if (++expressionOperators > MAX_EXPRESSION_OPERATORS) {
+        throw std::runtime_error("Слишком длинное выражение (больше " +
+                                 std::to_string(MAX_EXPRESSION_OPERATORS) + " операторов)");
+    }
+}
+
 std::unique_ptr<ASTNode> Parser::parseStatement() {
+    NestingGuard guard(nesting);
+    // expressions of enclosing statements are complete by now
+    expressionOperators = 0;
+    
+    // int name(...) { ... }
+    if ((isValueType(currentToken) || (match(TokenType::KEYWORD) && currentToken.value == "void")) &&
+        peek().type == TokenType::IDENTIFIER && peek(2).type == TokenType::LPAREN) {
+        return parseFunctionDefinition();
+    }
+    
     if (match(TokenType::KEYWORD) && 
         (currentToken.value == "int" || 
          currentToken.value == "float" || 
@@ -99,8 +157,19 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
         return parseWhileStatement();
     }
     
+    if (match(TokenType::KEYWORD) && currentToken.value == "return") {
+        return parseReturn();
+    }
+    
+    if (match(TokenType::KEYWORD) && currentToken.value == "import") {
+        return parseImport();
+    }
+    
     if (match(TokenType::IDENTIFIER) && peek().type == TokenType::LPAREN) {
-        return parseFunctionCall();
+        auto call = parseFunctionCall();
+        expect(TokenType::SEMICOLN, "Ожидается ';' после вызова функции");
+        advance();
+        return call;
     }
     
     if (match(TokenType::IDENTIFIER) && peek().value == "=") {
@@ -121,11 +190,12 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
 }
 
 std::unique_ptr<ASTNode> Parser::parseVarDeclaration() {
+    Token start = currentToken;
     std::string type = currentToken.value;
     advance(); 
     
     expect(TokenType::IDENTIFIER, "Ожидается имя переменной");
-    std::string name = currentToken.value;
+    SymbolId name = currentToken.symbol;
     advance();
     
     std::unique_ptr<ASTNode> initializer = nullptr;
@@ -138,13 +208,16 @@ std::unique_ptr<ASTNode> Parser::parseVarDeclaration() {
     expect(TokenType::SEMICOLN, "Ожидается ';' после объявления переменной");
     advance();
     
-    return std::unique_ptr<VarDeclarationNode>(
+    auto decl = std::unique_ptr<VarDeclarationNode>(
         new VarDeclarationNode(type, name, std::move(initializer))
     );
+    decl->setPosition(start);
+    return std::move(decl);
 }
 
 std::unique_ptr<ASTNode> Parser::parseAssignment() {
-    std::string name = currentToken.value;
+    Token start = currentToken;
+    SymbolId name = currentToken.symbol;
     advance(); 
     
     expect("=", "Ожидается '=' в присваивании");
@@ -155,12 +228,15 @@ std::unique_ptr<ASTNode> Parser::parseAssignment() {
     expect(TokenType::SEMICOLN, "Ожидается ';' после присваивания");
     advance();
     
-    return std::unique_ptr<AssignmentNode>(
+    auto assignment = std::unique_ptr<AssignmentNode>(
         new AssignmentNode(name, std::move(value))
     );
+    assignment->setPosition(start);
+    return std::move(assignment);
 }
 
 std::unique_ptr<ASTNode> Parser::parseIfStatement() {
+    Token start = currentToken;
     advance(); // пропускаем 'if'
     
     expect(TokenType::LPAREN, "Ожидается '(' после if");
@@ -172,9 +248,10 @@ std::unique_ptr<ASTNode> Parser::parseIfStatement() {
     advance();
     
     auto ifNode = std::unique_ptr<IfNode>(new IfNode(std::move(condition)));
+    ifNode->setPosition(start);
     
     if (match(TokenType::LBRACE)) {
-        parseBlock();  
+        parseBlockInto(ifNode->thenBody);
     } else {
         ifNode->thenBody.push_back(parseStatement());
     }
@@ -183,7 +260,7 @@ std::unique_ptr<ASTNode> Parser::parseIfStatement() {
         advance();
         
         if (match(TokenType::LBRACE)) {
-            parseBlock();
+            parseBlockInto(ifNode->elseBody);
         } else {
             ifNode->elseBody.push_back(parseStatement());
         }
@@ -193,6 +270,7 @@ std::unique_ptr<ASTNode> Parser::parseIfStatement() {
 }
 
 std::unique_ptr<ASTNode> Parser::parseWhileStatement() {
+    Token start = currentToken;
     advance(); 
     
     expect(TokenType::LPAREN, "Ожидается '(' после while");
@@ -204,9 +282,10 @@ std::unique_ptr<ASTNode> Parser::parseWhileStatement() {
     advance();
     
     auto whileNode = std::unique_ptr<WhileNode>(new WhileNode(std::move(condition)));
+    whileNode->setPosition(start);
     
     if (match(TokenType::LBRACE)) {
-        parseBlock();
+        parseBlockInto(whileNode->body);
     } else {
         whileNode->body.push_back(parseStatement());
     }
@@ -215,28 +294,39 @@ std::unique_ptr<ASTNode> Parser::parseWhileStatement() {
 }
 
 std::unique_ptr<ASTNode> Parser::parseBlock() {
+    auto block = std::unique_ptr<BlockNode>(new BlockNode());
+    block->setPosition(currentToken);
+    parseBlockInto(block->statements);
+    return std::move(block);
+}
+
+// statements of { ... } go straight into the owner's body (if/while)
+void Parser::parseBlockInto(std::vector<std::unique_ptr<ASTNode>>& body) {
     expect(TokenType::LBRACE, "Ожидается '{' в начале блока");
     advance();
     
     while (currentToken.type != TokenType::RBRACE && 
            currentToken.type != TokenType::END) {
-        parseStatement();
+        auto statement = parseStatement();
+        if (statement) {
+            body.push_back(std::move(statement));
+        }
     }
     
     expect(TokenType::RBRACE, "Ожидается '}' в конце блока");
     advance();
-    
-    return nullptr;
 }
 
 std::unique_ptr<ASTNode> Parser::parseFunctionCall() {
-    std::string name = currentToken.value;
+    Token start = currentToken;
+    SymbolId name = currentToken.symbol;
     advance(); 
     
     expect(TokenType::LPAREN, "Ожидается '(' после имени функции");
     advance();
     
     auto funcCall = std::unique_ptr<FunctionCallNode>(new FunctionCallNode(name));
+    funcCall->setPosition(start);
     
     // paring arguments 
     if (currentToken.type != TokenType::RPAREN) {
@@ -251,14 +341,94 @@ std::unique_ptr<ASTNode> Parser::parseFunctionCall() {
     expect(TokenType::RPAREN, "Ожидается ')' после аргументов");
     advance();
     
-    expect(TokenType::SEMICOLN, "Ожидается ';' после вызова функции");
+    return std::move(funcCall);
+}
+
+std::unique_ptr<ASTNode> Parser::parseFunctionDefinition() {
+    // nesting counts this statement too
+    if (nesting > 1) {
+        throw std::runtime_error("Функции объявляются только на верхнем уровне");
+    }
+    Token start = currentToken;
+    std::string returnType = currentToken.value;
+    advance();
+    
+    SymbolId name = currentToken.symbol;
     advance();
     
-    return std::move(funcCall);
+    expect(TokenType::LPAREN, "Ожидается '(' после имени функции");
+    advance();
+    
+    auto function = std::unique_ptr<FunctionDefNode>(new FunctionDefNode(returnType, name));
+    function->setPosition(start);
+    
+    if (currentToken.type != TokenType::RPAREN) {
+        for (;;) {
+            if (!isValueType(currentToken)) {
+                expect("int", "Ожидается тип параметра");
+            }
+            Parameter parameter;
+            parameter.type = currentToken.value;
+            advance();
+            
+            expect(TokenType::IDENTIFIER, "Ожидается имя параметра");
+            parameter.name = currentToken.symbol;
+            advance();
+            function->parameters.push_back(parameter);
+            
+            if (!match(TokenType::COMMA)) {
+                break;
+            }
+            advance();
+        }
+    }
+    
+    expect(TokenType::RPAREN, "Ожидается ')' после параметров");
+    advance();
+    
+    parseBlockInto(function->body);
+    return std::move(function);
+}
+
+std::unique_ptr<ASTNode> Parser::parseReturn() {
+    Token start = currentToken;
+    advance();
+    
+    std::unique_ptr<ASTNode> value;
+    if (currentToken.type != TokenType::SEMICOLN) {
+        value = parseExpression();
+    }
+    
+    expect(TokenType::SEMICOLN, "Ожидается ';' после return");
+    advance();
+    
+    auto node = std::unique_ptr<ReturnNode>(new ReturnNode(std::move(value)));
+    node->setPosition(start);
+    return std::move(node);
+}
+
+std::unique_ptr<ASTNode> Parser::parseImport() {
+    if (nesting > 1) {
+        throw std::runtime_error("import допускается только на верхнем уровне");
+    }
+    Token start = currentToken;
+    advance();
+    
+    expect(TokenType::STRING, "Ожидается путь к модулю в кавычках");
+    std::string path = currentToken.value;
+    advance();
+    
+    expect(TokenType::SEMICOLN, "Ожидается ';' после import");
+    advance();
+    
+    auto node = std::unique_ptr<ImportNode>(new ImportNode(path));
+    node->setPosition(start);
+    return std::move(node);
 }
 
 //parsing operators
 std::unique_ptr<ASTNode> Parser::parseExpression() {
+    NestingGuard guard(nesting);
     return parseComparison();
 }
 
@@ -272,12 +442,14 @@ std::unique_ptr<ASTNode> Parser::parseComparison() {
             currentToken.value == ">" || 
             currentToken.value == "<=" || 
             currentToken.value == ">=")) {
-        std::string op = currentToken.value;
+        Token opToken = currentToken;
+        countOperator();
         advance();
         auto right = parseAdditive();
         left = std::unique_ptr<BinaryOpNode>(
-            new BinaryOpNode(op, std::move(left), std::move(right))
+            new BinaryOpNode(opToken.value, std::move(left), std::move(right))
         );
+        left->setPosition(opToken);
     }
     
     return left;
@@ -288,12 +460,14 @@ std::unique_ptr<ASTNode> Parser::parseAdditive() {
     
     while (match(TokenType::OPERATOR) && 
            (currentToken.value == "+" || currentToken.value == "-")) {
-        std::string op = currentToken.value;
+        Token opToken = currentToken;
+        countOperator();
         advance();
         auto right = parseMultiplicative();
         left = std::unique_ptr<BinaryOpNode>(
-            new BinaryOpNode(op, std::move(left), std::move(right))
+            new BinaryOpNode(opToken.value, std::move(left), std::move(right))
         );
+        left->setPosition(opToken);
     }
     
     return left;
@@ -304,12 +478,14 @@ std::unique_ptr<ASTNode> Parser::parseMultiplicative() {
     
     while (match(TokenType::OPERATOR) && 
            (currentToken.value == "*" || currentToken.value == "/")) {
-        std::string op = currentToken.value;
+        Token opToken = currentToken;
+        countOperator();
         advance();
         auto right = parsePrimary();
         left = std::unique_ptr<BinaryOpNode>(
-            new BinaryOpNode(op, std::move(left), std::move(right))
+            new BinaryOpNode(opToken.value, std::move(left), std::move(right))
         );
+        left->setPosition(opToken);
     }
     
     return left;
@@ -320,6 +496,7 @@ std::unique_ptr<ASTNode> Parser::parsePrimary() {
         auto node = std::unique_ptr<NumberNode>(
             new NumberNode(currentToken.value)
         );
+        node->setPosition(currentToken);
         advance();
         return std::move(node);
     }
@@ -328,6 +505,7 @@ std::unique_ptr<ASTNode> Parser::parsePrimary() {
         auto node = std::unique_ptr<StringNode>(
             new StringNode(currentToken.value)
         );
+        node->setPosition(currentToken);
         advance();
         return std::move(node);
     }
@@ -338,8 +516,9 @@ std::unique_ptr<ASTNode> Parser::parsePrimary() {
         }
         
         auto node = std::unique_ptr<IdentifierNode>(
-            new IdentifierNode(currentToken.value)
+            new IdentifierNode(currentToken.symbol)
         );
+        node->setPosition(currentToken);
         advance();
         return std::move(node);
     }
@@ -355,25 +534,40 @@ std::unique_ptr<ASTNode> Parser::parsePrimary() {
     if (match(TokenType::KEYWORD) && 
         (currentToken.value == "true" || currentToken.value == "false")) {
         auto node = std::unique_ptr<IdentifierNode>(
-            new IdentifierNode(currentToken.value)
+            new IdentifierNode(currentToken.value == "true" ? SYM_TRUE : SYM_FALSE)
         );
+        node->setPosition(currentToken);
         advance();
         return std::move(node);
     }
     
-    std::cerr << "Неожиданный токен: " << currentToken.value << std::endl;
-    advance();
-    return nullptr;
+    // parse() skips to the next ';' from here
+    throw std::runtime_error("Неожиданный токен: " + currentToken.value);
 }
 
-void Parser::printAST(const std::vector<std::unique_ptr<ASTNode>>& ast) {
-    std::cout << "\n=== AST (Abstract Syntax Tree) ===\n\n";
+void Parser::printAST(const std::vector<std::unique_ptr<ASTNode>>& ast, std::ostream& out) {
+    out << "\n=== AST (Abstract Syntax Tree) ===\n\n";
     
     for (size_t i = 0; i < ast.size(); ++i) {
-        std::cout << i + 1 << ": " << ast[i]->toString() << std::endl;
+        out << i + 1 << ": " << ast[i]->toString() << std::endl;
     }
     
     if (ast.empty()) {
-        std::cout << "Программа пуста\n";
+        out << "Программа пуста\n";
+    }
+}
+
+int32_t intLiteralValue(const std::string& literal) {
+    bool negative = !literal.empty() && literal[0] == '-';
+    uint32_t value = 0;
+    for (size_t i = negative ? 1 : 0; i < literal.size(); ++i) {
+        value = value * 10 + static_cast<uint32_t>(literal[i] - '0');
     }
+    return static_cast<int32_t>(negative ? 0u - value : value);
+}
+
+double floatLiteralValue(const std::string& literal) {
+    // on overflow and underflow strtod sets ERANGE and returns HUGE_VAL or
+    // the rounded value, where std::stod would throw
+    return std::strtod(literal.c_str(), nullptr);
 }
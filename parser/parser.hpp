@@ -2,41 +2,87 @@
 #define PARSER_HPP
 
 #include "../lexer/lexer.hpp"
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <string>
 #include <iostream>
 
 
+// static type resolved by the type checker (semantic/type_checker.hpp)
+enum class StaticType {
+    UNKNOWN,  // not checked yet or ill-typed
+    INT,
+    FLOAT,
+    STRING,
+    BOOL,
+    VOID,     // result of print(...) and of void functions
+};
+
 struct ASTNode {
+    StaticType staticType = StaticType::UNKNOWN;
+    // position of the node's first token (of the operator for a BinaryOpNode),
+    // 0 for nodes built by the optimizers without a source counterpart
+    int line = 0;
+    int column = 0;
+    
     virtual ~ASTNode() = default;
-    virtual std::string toString() const = 0;
+    
+    void setPosition(const Token& token) {
+        line = token.line;
+        column = token.column;
+    }
+    void copyPosition(const ASTNode& other) {
+        line = other.line;
+        column = other.column;
+    }
+    // appends the dump to out; one buffer for the whole tree keeps
+    // printing linear in its size, however deep it is
+    virtual void writeTo(std::string& out) const = 0;
+    
+    std::string toString() const {
+        std::string result;
+        writeTo(result);
+        return result;
+    }
 };
 
 struct NumberNode : ASTNode {
     std::string value;
     
     NumberNode(const std::string& val) : value(val) {}
-    std::string toString() const override {
-        return "Number(" + value + ")";
+    void writeTo(std::string& out) const override {
+        out += "Number(";
+        out += value;
+        out += ")";
     }
 };
 
+// Values of number literal texts, the only place they are converted. Never
+// throw: an int literal wraps modulo 2^32 like the runtime arithmetic, a float
+// literal out of the double range becomes inf or 0.
+int32_t intLiteralValue(const std::string& literal);
+double floatLiteralValue(const std::string& literal);
+
 struct StringNode : ASTNode {
     std::string value;
     
     StringNode(const std::string& val) : value(val) {}
-    std::string toString() const override {
-        return "String(\"" + value + "\")";
+    void writeTo(std::string& out) const override {
+        out += "String(\"";
+        out += value;
+        out += "\")";
     }
 };
 
 struct IdentifierNode : ASTNode {
-    std::string name;
+    SymbolId name;
     
-    IdentifierNode(const std::string& n) : name(n) {}
-    std::string toString() const override {
-        return "Identifier(" + name + ")";
+    IdentifierNode(SymbolId n) : name(n) {}
+    void writeTo(std::string& out) const override {
+        out += "Identifier(";
+        out += symbolName(name);
+        out += ")";
     }
 };
 
@@ -50,35 +96,68 @@ struct BinaryOpNode : ASTNode {
                  std::unique_ptr<ASTNode> r)
         : op(o), left(std::move(l)), right(std::move(r)) {}
     
-    std::string toString() const override {
-        return "(" + left->toString() + " " + op + " " + right->toString() + ")";
+    void writeTo(std::string& out) const override {
+        out += "(";
+        left->writeTo(out);
+        out += " ";
+        out += op;
+        out += " ";
+        right->writeTo(out);
+        out += ")";
+    }
+};
+
+// int value stored into a float variable, parameter or return value; never
+// parsed, inserted by the type checker so the runtime type matches the checked one
+struct IntToFloatNode : ASTNode {
+    std::unique_ptr<ASTNode> operand;
+    
+    IntToFloatNode(std::unique_ptr<ASTNode> o) : operand(std::move(o)) {}
+    
+    void writeTo(std::string& out) const override {
+        out += "IntToFloat(";
+        operand->writeTo(out);
+        out += ")";
     }
 };
 
 struct VarDeclarationNode : ASTNode {
     std::string type;      // int, float, string, bool
-    std::string name;      
+    SymbolId name;
     std::unique_ptr<ASTNode> initializer;  // начальное значение
     
-    VarDeclarationNode(const std::string& t, const std::string& n,
+    VarDeclarationNode(const std::string& t, SymbolId n,
                       std::unique_ptr<ASTNode> init)
         : type(t), name(n), initializer(std::move(init)) {}
     
-    std::string toString() const override {
-        return "VarDecl(" + type + " " + name + " = " + 
-               (initializer ? initializer->toString() : "?") + ")";
+    void writeTo(std::string& out) const override {
+        out += "VarDecl(";
+        out += type;
+        out += " ";
+        out += symbolName(name);
+        out += " = ";
+        if (initializer) {
+            initializer->writeTo(out);
+        } else {
+            out += "?";
+        }
+        out += ")";
     }
 };
 
 struct AssignmentNode : ASTNode {
-    std::string name;
+    SymbolId name;
     std::unique_ptr<ASTNode> value;
     
-    AssignmentNode(const std::string& n, std::unique_ptr<ASTNode> v)
+    AssignmentNode(SymbolId n, std::unique_ptr<ASTNode> v)
         : name(n), value(std::move(v)) {}
     
-    std::string toString() const override {
-        return "Assignment(" + name + " = " + value->toString() + ")";
+    void writeTo(std::string& out) const override {
+        out += "Assignment(";
+        out += symbolName(name);
+        out += " = ";
+        value->writeTo(out);
+        out += ")";
     }
 };
 
@@ -91,18 +170,21 @@ struct IfNode : ASTNode {
     IfNode(std::unique_ptr<ASTNode> cond)
         : condition(std::move(cond)) {}
     
-    std::string toString() const override {
-        std::string result = "If(" + condition->toString() + ")\n  Then: ";
+    void writeTo(std::string& out) const override {
+        out += "If(";
+        condition->writeTo(out);
+        out += ")\n  Then: ";
         for (const auto& stmt : thenBody) {
-            result += "\n    " + stmt->toString();
+            out += "\n    ";
+            stmt->writeTo(out);
         }
         if (!elseBody.empty()) {
-            result += "\n  Else:";
+            out += "\n  Else:";
             for (const auto& stmt : elseBody) {
-                result += "\n    " + stmt->toString();
+                out += "\n    ";
+                stmt->writeTo(out);
             }
         }
-        return result;
     }
 };
 
@@ -114,29 +196,114 @@ struct WhileNode : ASTNode {
     WhileNode(std::unique_ptr<ASTNode> cond)
         : condition(std::move(cond)) {}
     
-    std::string toString() const override {
-        std::string result = "While(" + condition->toString() + ")";
+    void writeTo(std::string& out) const override {
+        out += "While(";
+        condition->writeTo(out);
+        out += ")";
         for (const auto& stmt : body) {
-            result += "\n    " + stmt->toString();
+            out += "\n    ";
+            stmt->writeTo(out);
         }
-        return result;
+    }
+};
+
+// Bare block { ... }
+struct BlockNode : ASTNode {
+    std::vector<std::unique_ptr<ASTNode>> statements;
+    
+    void writeTo(std::string& out) const override {
+        out += "Block(";
+        for (const auto& stmt : statements) {
+            out += "\n    ";
+            stmt->writeTo(out);
+        }
+        out += ")";
     }
 };
 
 struct FunctionCallNode : ASTNode {
-    std::string name;
+    SymbolId name;
     std::vector<std::unique_ptr<ASTNode>> arguments;
     
-    FunctionCallNode(const std::string& n) : name(n) {}
+    FunctionCallNode(SymbolId n) : name(n) {}
     
-    std::string toString() const override {
-        std::string result = "Call(" + name + ", [";
+    void writeTo(std::string& out) const override {
+        out += "Call(";
+        out += symbolName(name);
+        out += ", [";
         for (size_t i = 0; i < arguments.size(); ++i) {
+            if (i > 0) out += ", ";
+            arguments[i]->writeTo(out);
+        }
+        out += "])";
+    }
+};
+
+// return; / return expr;
+struct ReturnNode : ASTNode {
+    std::unique_ptr<ASTNode> value;  // nullptr in a void function
+    
+    ReturnNode(std::unique_ptr<ASTNode> v) : value(std::move(v)) {}
+    
+    void writeTo(std::string& out) const override {
+        out += "Return(";
+        if (value) {
+            value->writeTo(out);
+        }
+        out += ")";
+    }
+};
+
+struct Parameter {
+    std::string type;
+    SymbolId name;
+};
+
+// Top-level function definition. The body sees its parameters and its own
+// locals only, never the globals, so every function can be checked and
+// optimized on its own.
+struct FunctionDefNode : ASTNode {
+    std::string returnType;  // int, float, string, bool, void
+    SymbolId name;
+    std::vector<Parameter> parameters;
+    std::vector<std::unique_ptr<ASTNode>> body;
+    
+    FunctionDefNode(const std::string& t, SymbolId n) : returnType(t), name(n) {}
+    
+    // "int f(int a, float b)"
+    std::string signature() const {
+        std::string result = returnType + " " + symbolName(name) + "(";
+        for (size_t i = 0; i < parameters.size(); ++i) {
             if (i > 0) result += ", ";
-            result += arguments[i]->toString();
+            result += parameters[i].type;
+            result += " ";
+            result += symbolName(parameters[i].name);
         }
-        result += "])";
-        return result;
+        return result + ")";
+    }
+    
+    void writeTo(std::string& out) const override {
+        out += "Function(";
+        out += signature();
+        out += ")";
+        for (const auto& stmt : body) {
+            out += "\n    ";
+            stmt->writeTo(out);
+        }
+    }
+};
+
+// import "path"; at the top level. The module loader (module/) replaces it
+// with the functions of the module before type checking.
+struct ImportNode : ASTNode {
+    std::string path;  // as written, relative to the importing file
+    
+    ImportNode(const std::string& p) : path(p) {}
+    
+    void writeTo(std::string& out) const override {
+        out += "Import(\"";
+        out += path;
+        out += "\")";
     }
 };
 
@@ -146,9 +313,15 @@ private:
     std::vector<Token> tokens;
     size_t position;
     Token currentToken;
+    std::ostream* errors;  // syntax error messages, std::cerr by default
+    int nesting;                 // parseStatement/parseExpression frames on the stack
+    size_t expressionOperators;  // binary operators since the current statement began
+    size_t syntaxErrors;         // reported by parse()
+    
+    void countOperator();
 
     void advance();           
-    Token peek(int offset = 0); 
+    Token peek(int offset = 1); 
     bool match(TokenType type); 
     bool match(const std::string& value); 
     void expect(TokenType type, const std::string& errorMessage);
@@ -167,16 +340,30 @@ private:
     std::unique_ptr<ASTNode> parseIfStatement();
     std::unique_ptr<ASTNode> parseWhileStatement();
     std::unique_ptr<ASTNode> parseBlock();
+    void parseBlockInto(std::vector<std::unique_ptr<ASTNode>>& body);
     std::unique_ptr<ASTNode> parseFunctionCall();
+    std::unique_ptr<ASTNode> parseFunctionDefinition();
+    std::unique_ptr<ASTNode> parseReturn();
+    std::unique_ptr<ASTNode> parseImport();
     
 public:
+    // Limits that keep the tree shallow enough for the recursive passes
+    // (printing, type checking, optimizers, interpreter) on hostile input.
+    static const int MAX_NESTING = 256;
+    static const size_t MAX_EXPRESSION_OPERATORS = 10000;
+    // parse() gives up after this many syntax errors, later ones are mostly cascades
+    static const size_t MAX_ERRORS = 100;
+    
     Parser(const std::vector<Token>& inputTokens);
+    void setErrorStream(std::ostream& stream);
     
     // main func parser's
     std::vector<std::unique_ptr<ASTNode>> parse();
+    // syntax errors reported by parse(); the program is incomplete unless 0
+    size_t errorCount() const { return syntaxErrors; }
     
 
-    void printAST(const std::vector<std::unique_ptr<ASTNode>>& ast);
+    void printAST(const std::vector<std::unique_ptr<ASTNode>>& ast, std::ostream& out = std::cout);
 };
 
 #endif
@@ -0,0 +1,27 @@
+#include "diagnostics.hpp"
+
+const char* diagnosticKindName(DiagnosticKind kind) {
+    switch (kind) {
+        case DiagnosticKind::UNDECLARED_VARIABLE: return "undeclared-variable";
+        case DiagnosticKind::REDECLARED_VARIABLE: return "redeclared-variable";
+        case DiagnosticKind::UNKNOWN_FUNCTION:    return "unknown-function";
+        case DiagnosticKind::TYPE_MISMATCH:       return "type-mismatch";
+        case DiagnosticKind::INVALID_OPERANDS:    return "invalid-operands";
+        case DiagnosticKind::NON_BOOL_CONDITION:  return "non-bool-condition";
+        case DiagnosticKind::REDECLARED_FUNCTION: return "redeclared-function";
+        case DiagnosticKind::ARGUMENT_MISMATCH:   return "argument-mismatch";
+        case DiagnosticKind::RETURN_MISMATCH:     return "return-mismatch";
+        case DiagnosticKind::MISSING_RETURN:      return "missing-return";
+    }
+    return "unknown";
+}
+
+void printDiagnostics(const std::vector<Diagnostic>& diagnostics, std::ostream& out) {
+    for (const auto& diagnostic : diagnostics) {
+        out << "Ошибка [" << diagnosticKindName(diagnostic.kind) << "]";
+        if (diagnostic.line > 0) {
+            out << " в строке " << diagnostic.line;
+        }
+        out << ": " << diagnostic.message << "\n    в " << diagnostic.context << "\n";
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum class DiagnosticKind {
+    UNDECLARED_VARIABLE,
+    REDECLARED_VARIABLE,
+    UNKNOWN_FUNCTION,
+    TYPE_MISMATCH,      // initializer/assigned value vs declared type
+    INVALID_OPERANDS,   // e.g. string * int
+    NON_BOOL_CONDITION,
+    REDECLARED_FUNCTION,
+    ARGUMENT_MISMATCH,  // argument count or types vs the parameters
+    RETURN_MISMATCH,    // return value vs the declared return type
+    MISSING_RETURN,     // a non-void function can end without return
+};
+
+struct Diagnostic {
+    DiagnosticKind kind;
+    std::string message;
+    std::string context;  // the offending statement
+    int line;             // of that statement, 0 if unknown
+    
+    Diagnostic(DiagnosticKind k, const std::string& m, const std::string& c, int l = 0)
+        : kind(k), message(m), context(c), line(l) {}
+};
+
+const char* diagnosticKindName(DiagnosticKind kind);
+void printDiagnostics(const std::vector<Diagnostic>& diagnostics, std::ostream& out = std::cerr);
+
+#endif
@@ -0,0 +1,78 @@
+#include "symbol_table.hpp"
+
+SymbolTable::SymbolTable(size_t expectedNames) : occupied(0) {
+    size_t capacity = 16;
+    while (capacity < expectedNames * 2) {
+        capacity *= 2;
+    }
+    Slot empty = {EMPTY, -1};
+    slots.assign(capacity, empty);
+    mask = capacity - 1;
+}
+
+// Fibonacci hashing spreads the dense ids over the table
+size_t SymbolTable::findSlot(SymbolId key) const {
+    size_t index = (key * 2654435769u) & mask;
+    while (slots[index].key != key && slots[index].key != EMPTY) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+void SymbolTable::grow() {
+    std::vector<Slot> old;
+    old.swap(slots);
+    Slot empty = {EMPTY, -1};
+    slots.assign(old.size() * 2, empty);
+    mask = slots.size() - 1;
+    for (const auto& slot : old) {
+        if (slot.key != EMPTY) {
+            slots[findSlot(slot.key)] = slot;
+        }
+    }
+}
+
+void SymbolTable::enterScope() {
+    scopeStarts.push_back(symbols.size());
+}
+
+void SymbolTable::exitScope() {
+    size_t start = scopeStarts.back();
+    scopeStarts.pop_back();
+    while (symbols.size() > start) {
+        const Symbol& symbol = symbols.back();
+        slots[findSlot(symbol.name)].symbol = symbol.shadowed;
+        symbols.pop_back();
+    }
+}
+
+bool SymbolTable::declare(SymbolId name, StaticType type) {
+    size_t index = findSlot(name);
+    int32_t current = slots[index].key == name ? slots[index].symbol : -1;
+    if (current >= 0 && symbols[current].depth == depth()) {
+        return false;
+    }
+    
+    if (slots[index].key == EMPTY) {
+        // keep the load factor at or below 1/2
+        if ((occupied + 1) * 2 > slots.size()) {
+            grow();
+            index = findSlot(name);
+        }
+        slots[index].key = name;
+        occupied++;
+    }
+    
+    Symbol symbol = {name, type, depth(), current};
+    symbols.push_back(symbol);
+    slots[index].symbol = static_cast<int32_t>(symbols.size() - 1);
+    return true;
+}
+
+const Symbol* SymbolTable::lookup(SymbolId name) const {
+    const Slot& slot = slots[findSlot(name)];
+    if (slot.key != name || slot.symbol < 0) {
+        return nullptr;
+    }
+    return &symbols[slot.symbol];
+}
@@ -0,0 +1,47 @@
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+#include "../parser/parser.hpp"
+#include "../util/interner.hpp"
+
+struct Symbol {
+    SymbolId name;
+    StaticType type;
+    int depth;         // scope nesting level of the declaration
+    int32_t shadowed;  // symbol hidden by this one, -1 if none
+};
+
+// Scoped symbol table on a flat open-addressing hash map (linear probing,
+// power-of-two capacity) keyed by interned ids. Each slot points at the
+// innermost visible symbol; leaving a scope restores the shadowed ones.
+class SymbolTable {
+private:
+    static const SymbolId EMPTY = 0xFFFFFFFFu;
+    
+    struct Slot {
+        SymbolId key;
+        int32_t symbol;  // index into symbols, -1 when the name is out of scope
+    };
+    
+    std::vector<Slot> slots;
+    size_t mask;
+    size_t occupied;
+    std::vector<Symbol> symbols;     // declaration stack
+    std::vector<size_t> scopeStarts; // symbols.size() at each enterScope
+    
+    size_t findSlot(SymbolId key) const;
+    void grow();
+    
+public:
+    SymbolTable(size_t expectedNames = 64);
+    
+    void enterScope();
+    void exitScope();
+    int depth() const { return static_cast<int>(scopeStarts.size()); }
+    
+    // false if the name is already declared in the current scope
+    bool declare(SymbolId name, StaticType type);
+    const Symbol* lookup(SymbolId name) const;
+};
+
+#endif
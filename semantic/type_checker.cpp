@@ -0,0 +1,379 @@
+#include "type_checker.hpp"
+#include <algorithm>
+
+const char* staticTypeName(StaticType type) {
+    switch (type) {
+        case StaticType::INT:     return "int";
+        case StaticType::FLOAT:   return "float";
+        case StaticType::STRING:  return "string";
+        case StaticType::BOOL:    return "bool";
+        case StaticType::VOID:    return "void";
+        case StaticType::UNKNOWN: return "?";
+    }
+    return "?";
+}
+
+StaticType staticTypeFromName(const std::string& name) {
+    if (name == "int") return StaticType::INT;
+    if (name == "float") return StaticType::FLOAT;
+    if (name == "string") return StaticType::STRING;
+    if (name == "bool") return StaticType::BOOL;
+    if (name == "void") return StaticType::VOID;
+    return StaticType::UNKNOWN;
+}
+
+static bool isNumeric(StaticType type) {
+    return type == StaticType::INT || type == StaticType::FLOAT;
+}
+
+static bool isComparison(const std::string& op) {
+    return op == "==" || op == "!=" || op == "<" || op == ">" ||
+           op == "<=" || op == ">=";
+}
+
+// int widens to float, everything else must match exactly
+static bool isAssignable(StaticType target, StaticType value) {
+    return target == value || (target == StaticType::FLOAT && value == StaticType::INT);
+}
+
+// makes the widening explicit: without it the value would stay an int at run
+// time, and float f = 1; f / 2 would divide as ints
+static void widen(StaticType target, std::unique_ptr<ASTNode>& value) {
+    if (target != StaticType::FLOAT || value->staticType != StaticType::INT) {
+        return;
+    }
+    std::unique_ptr<ASTNode> conversion(new IntToFloatNode(std::move(value)));
+    conversion->copyPosition(*static_cast<IntToFloatNode*>(conversion.get())->operand);
+    conversion->staticType = StaticType::FLOAT;
+    value = std::move(conversion);
+}
+
+// no path falls off the end of body; there is no break, so while (true) never does
+static bool alwaysReturns(const std::vector<std::unique_ptr<ASTNode>>& body) {
+    for (const auto& stmt : body) {
+        if (dynamic_cast<const ReturnNode*>(stmt.get())) {
+            return true;
+        }
+        if (auto ifNode = dynamic_cast<const IfNode*>(stmt.get())) {
+            if (alwaysReturns(ifNode->thenBody) && alwaysReturns(ifNode->elseBody)) {
+                return true;
+            }
+        } else if (auto block = dynamic_cast<const BlockNode*>(stmt.get())) {
+            if (alwaysReturns(block->statements)) {
+                return true;
+            }
+        } else if (auto whileNode = dynamic_cast<const WhileNode*>(stmt.get())) {
+            auto condition = dynamic_cast<const IdentifierNode*>(whileNode->condition.get());
+            if (condition && condition->name == SYM_TRUE) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+TypeChecker::TypeChecker()
+    : currentStatement(nullptr), functions(&ownFunctions), currentFunction(nullptr) {}
+
+const std::vector<Diagnostic>& TypeChecker::check(std::vector<std::unique_ptr<ASTNode>>& program,
+                                                  ThreadPool* pool) {
+    diagnostics.clear();
+    std::vector<FunctionDefNode*> definitions;
+    collectFunctions(program, definitions);
+    
+    symbols.enterScope();
+    checkBody(program);
+    symbols.exitScope();
+    
+    std::vector<std::vector<Diagnostic>> results(definitions.size());
+    parallelFor(pool, definitions.size(), [&](size_t i) {
+        TypeChecker worker;
+        worker.functions = functions;
+        worker.checkFunction(definitions[i]);
+        results[i] = std::move(worker.diagnostics);
+    });
+    for (auto& result : results) {
+        diagnostics.insert(diagnostics.end(), result.begin(), result.end());
+    }
+    std::stable_sort(diagnostics.begin(), diagnostics.end(),
+                     [](const Diagnostic& a, const Diagnostic& b) { return a.line < b.line; });
+    return diagnostics;
+}
+
+// functions may be called before their definition
+void TypeChecker::collectFunctions(std::vector<std::unique_ptr<ASTNode>>& program,
+                                   std::vector<FunctionDefNode*>& definitions) {
+    functions = &ownFunctions;
+    for (auto& stmt : program) {
+        auto function = dynamic_cast<FunctionDefNode*>(stmt.get());
+        if (!function) {
+            continue;
+        }
+        definitions.push_back(function);
+        currentStatement = function;
+        if (function->name == SYM_PRINT ||
+            !ownFunctions.insert(std::make_pair(function->name, function)).second) {
+            report(DiagnosticKind::REDECLARED_FUNCTION,
+                   "Функция " + symbolName(function->name) + " уже объявлена");
+        }
+    }
+    currentStatement = nullptr;
+}
+
+void TypeChecker::importFunction(const FunctionDefNode* function) {
+    ownFunctions.insert(std::make_pair(function->name, function));
+}
+
+void TypeChecker::checkFunction(FunctionDefNode* function) {
+    currentFunction = function;
+    currentStatement = function;
+    // parameters share the scope of the outermost block of the body, as in C
+    symbols.enterScope();
+    for (const auto& parameter : function->parameters) {
+        if (!symbols.declare(parameter.name, staticTypeFromName(parameter.type))) {
+            report(DiagnosticKind::REDECLARED_VARIABLE,
+                   "Параметр " + symbolName(parameter.name) + " повторяется");
+        }
+    }
+    checkBody(function->body);
+    symbols.exitScope();
+    
+    if (function->returnType != "void" && !alwaysReturns(function->body)) {
+        currentStatement = function;
+        report(DiagnosticKind::MISSING_RETURN,
+               "Функция " + symbolName(function->name) + " может завершиться без return");
+    }
+    currentFunction = nullptr;
+}
+
+void TypeChecker::checkReturn(ReturnNode* ret) {
+    StaticType value = ret->value ? checkExpression(ret->value.get()) : StaticType::VOID;
+    if (!currentFunction) {
+        report(DiagnosticKind::RETURN_MISMATCH, "return вне функции");
+        return;
+    }
+    
+    const std::string& name = symbolName(currentFunction->name);
+    StaticType expected = staticTypeFromName(currentFunction->returnType);
+    if (expected == StaticType::VOID) {
+        if (ret->value) {
+            report(DiagnosticKind::RETURN_MISMATCH, "Функция " + name + " не возвращает значения");
+        }
+    } else if (!ret->value) {
+        report(DiagnosticKind::RETURN_MISMATCH,
+               "Функция " + name + " должна вернуть значение типа " + staticTypeName(expected));
+    } else if (value != StaticType::UNKNOWN && !isAssignable(expected, value)) {
+        report(DiagnosticKind::RETURN_MISMATCH,
+               "Функция " + name + " возвращает " + staticTypeName(expected) +
+               ", а не " + staticTypeName(value));
+    } else {
+        widen(expected, ret->value);
+    }
+}
+
+// the statement without its body: a function error would otherwise print
+// the whole function, an if or while error everything nested in it
+static std::string statementContext(const ASTNode* stmt) {
+    if (auto function = dynamic_cast<const FunctionDefNode*>(stmt)) {
+        return "Function(" + function->signature() + ")";
+    }
+    std::string text = stmt->toString();
+    return text.substr(0, text.find('\n'));
+}
+
+void TypeChecker::report(DiagnosticKind kind, const std::string& message) {
+    diagnostics.push_back(Diagnostic(kind, message,
+        currentStatement ? statementContext(currentStatement) : "",
+        currentStatement ? currentStatement->line : 0));
+}
+
+void TypeChecker::checkBody(const std::vector<std::unique_ptr<ASTNode>>& body) {
+    for (const auto& stmt : body) {
+        checkStatement(stmt.get());
+    }
+}
+
+void TypeChecker::checkStatement(ASTNode* stmt) {
+    currentStatement = stmt;
+    
+    if (auto decl = dynamic_cast<VarDeclarationNode*>(stmt)) {
+        StaticType declared = staticTypeFromName(decl->type);
+        // the initializer sees the outer binding of the name
+        if (decl->initializer) {
+            checkAssignable(declared, checkExpression(decl->initializer.get()), decl->name);
+            widen(declared, decl->initializer);
+        }
+        // the interpreter and the optimizers keep one variable per name, so
+        // a declaration may not hide one from an enclosing scope either
+        if (const Symbol* visible = symbols.lookup(decl->name)) {
+            report(DiagnosticKind::REDECLARED_VARIABLE,
+                   "Переменная " + symbolName(decl->name) + " уже объявлена" +
+                   (visible->depth == symbols.depth() ? " в этой области" : " во внешней области"));
+        } else {
+            symbols.declare(decl->name, declared);
+        }
+        return;
+    }
+    
+    if (auto assign = dynamic_cast<AssignmentNode*>(stmt)) {
+        StaticType value = checkExpression(assign->value.get());
+        const Symbol* symbol = symbols.lookup(assign->name);
+        if (!symbol) {
+            report(DiagnosticKind::UNDECLARED_VARIABLE,
+                   "Присваивание необъявленной переменной " + symbolName(assign->name));
+            return;
+        }
+        checkAssignable(symbol->type, value, assign->name);
+        widen(symbol->type, assign->value);
+        return;
+    }
+    
+    if (auto ifNode = dynamic_cast<IfNode*>(stmt)) {
+        checkCondition(ifNode->condition.get());
+        symbols.enterScope();
+        checkBody(ifNode->thenBody);
+        symbols.exitScope();
+        symbols.enterScope();
+        checkBody(ifNode->elseBody);
+        symbols.exitScope();
+        return;
+    }
+    
+    if (auto whileNode = dynamic_cast<WhileNode*>(stmt)) {
+        checkCondition(whileNode->condition.get());
+        symbols.enterScope();
+        checkBody(whileNode->body);
+        symbols.exitScope();
+        return;
+    }
+    
+    if (auto block = dynamic_cast<BlockNode*>(stmt)) {
+        symbols.enterScope();
+        checkBody(block->statements);
+        symbols.exitScope();
+        return;
+    }
+    
+    if (auto ret = dynamic_cast<ReturnNode*>(stmt)) {
+        checkReturn(ret);
+        return;
+    }
+    
+    // bodies are checked on their own by check(); imports are the module
+    // loader's business
+    if (dynamic_cast<FunctionDefNode*>(stmt) || dynamic_cast<ImportNode*>(stmt)) {
+        return;
+    }
+    
+    checkExpression(stmt);
+}
+
+void TypeChecker::checkCondition(ASTNode* condition) {
+    StaticType type = checkExpression(condition);
+    if (type != StaticType::BOOL && type != StaticType::UNKNOWN) {
+        report(DiagnosticKind::NON_BOOL_CONDITION,
+               std::string("Условие должно иметь тип bool, получен ") + staticTypeName(type));
+    }
+}
+
+void TypeChecker::checkAssignable(StaticType target, StaticType value, SymbolId name) {
+    if (target == StaticType::UNKNOWN || value == StaticType::UNKNOWN || isAssignable(target, value)) {
+        return;
+    }
+    report(DiagnosticKind::TYPE_MISMATCH,
+           std::string("Нельзя присвоить значение типа ") + staticTypeName(value) +
+           " переменной " + symbolName(name) + " типа " + staticTypeName(target));
+}
+
+StaticType TypeChecker::checkExpression(ASTNode* expr) {
+    StaticType type = StaticType::UNKNOWN;
+    
+    if (auto number = dynamic_cast<NumberNode*>(expr)) {
+        type = number->value.find('.') == std::string::npos ? StaticType::INT : StaticType::FLOAT;
+    } else if (dynamic_cast<StringNode*>(expr)) {
+        type = StaticType::STRING;
+    } else if (auto ident = dynamic_cast<IdentifierNode*>(expr)) {
+        if (ident->name == SYM_TRUE || ident->name == SYM_FALSE) {
+            type = StaticType::BOOL;
+        } else if (const Symbol* symbol = symbols.lookup(ident->name)) {
+            type = symbol->type;
+        } else {
+            report(DiagnosticKind::UNDECLARED_VARIABLE,
+                   "Необъявленная переменная " + symbolName(ident->name));
+        }
+    } else if (auto binary = dynamic_cast<BinaryOpNode*>(expr)) {
+        StaticType left = checkExpression(binary->left.get());
+        StaticType right = checkExpression(binary->right.get());
+        
+        // one error per operand, no cascades
+        if (left == StaticType::UNKNOWN || right == StaticType::UNKNOWN) {
+            type = StaticType::UNKNOWN;
+        } else if (isComparison(binary->op)) {
+            bool equality = binary->op == "==" || binary->op == "!=";
+            if ((isNumeric(left) && isNumeric(right)) ||
+                (left == StaticType::STRING && right == StaticType::STRING) ||
+                (left == StaticType::BOOL && right == StaticType::BOOL && equality)) {
+                type = StaticType::BOOL;
+            }
+        } else if (isNumeric(left) && isNumeric(right)) {
+            type = (left == StaticType::FLOAT || right == StaticType::FLOAT)
+                ? StaticType::FLOAT : StaticType::INT;
+        } else if (left == StaticType::STRING && right == StaticType::STRING && binary->op == "+") {
+            type = StaticType::STRING;
+        }
+        
+        if (type == StaticType::UNKNOWN && left != StaticType::UNKNOWN && right != StaticType::UNKNOWN) {
+            report(DiagnosticKind::INVALID_OPERANDS,
+                   std::string("Недопустимые операнды для ") + binary->op + ": " +
+                   staticTypeName(left) + " и " + staticTypeName(right));
+        }
+    } else if (auto call = dynamic_cast<FunctionCallNode*>(expr)) {
+        type = checkCall(call);
+    } else if (auto conversion = dynamic_cast<IntToFloatNode*>(expr)) {
+        checkExpression(conversion->operand.get());
+        type = StaticType::FLOAT;
+    }
+    
+    expr->staticType = type;
+    return type;
+}
+
+StaticType TypeChecker::checkCall(FunctionCallNode* call) {
+    const std::string& name = symbolName(call->name);
+    std::vector<StaticType> arguments;
+    for (auto& arg : call->arguments) {
+        arguments.push_back(checkExpression(arg.get()));
+        if (arguments.back() == StaticType::VOID) {
+            report(DiagnosticKind::ARGUMENT_MISMATCH,
+                   "Значение void передано как аргумент функции " + name);
+        }
+    }
+    if (call->name == SYM_PRINT) {
+        return StaticType::VOID;
+    }
+    
+    auto it = functions->find(call->name);
+    if (it == functions->end()) {
+        report(DiagnosticKind::UNKNOWN_FUNCTION, "Неизвестная функция " + name);
+        return StaticType::UNKNOWN;
+    }
+    
+    const FunctionDefNode* callee = it->second;
+    if (arguments.size() != callee->parameters.size()) {
+        report(DiagnosticKind::ARGUMENT_MISMATCH,
+               "Функция " + name + " принимает " + std::to_string(callee->parameters.size()) +
+               " аргумент(ов), передано " + std::to_string(arguments.size()));
+    } else {
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            StaticType expected = staticTypeFromName(callee->parameters[i].type);
+            if (arguments[i] != StaticType::UNKNOWN && arguments[i] != StaticType::VOID &&
+                !isAssignable(expected, arguments[i])) {
+                report(DiagnosticKind::ARGUMENT_MISMATCH,
+                       "Аргумент " + std::to_string(i + 1) + " функции " + name + ": ожидается " +
+                       staticTypeName(expected) + ", получен " + staticTypeName(arguments[i]));
+            }
+            widen(expected, call->arguments[i]);
+        }
+    }
+    return staticTypeFromName(callee->returnType);
+}
@@ -0,0 +1,53 @@
+#ifndef TYPE_CHECKER_HPP
+#define TYPE_CHECKER_HPP
+
+#include "diagnostics.hpp"
+#include "symbol_table.hpp"
+#include "../util/thread_pool.hpp"
+#include <unordered_map>
+
+const char* staticTypeName(StaticType type);
+StaticType staticTypeFromName(const std::string& name);  // "int" -> INT, ...
+
+typedef std::unordered_map<SymbolId, const FunctionDefNode*> FunctionTable;
+
+// Semantic pass: resolves every expression to a static type (ASTNode::staticType)
+// and reports mismatches. Each if/while body and block opens a scope; a
+// declaration may not hide a visible name (there is no shadowing).
+// Function bodies only see their parameters and locals, so each one is checked
+// by its own TypeChecker, in parallel when check() is given a pool.
+class TypeChecker {
+private:
+    SymbolTable symbols;
+    std::vector<Diagnostic> diagnostics;
+    const ASTNode* currentStatement;
+    FunctionTable ownFunctions;
+    const FunctionTable* functions;           // signatures, shared read-only by the workers
+    const FunctionDefNode* currentFunction;   // nullptr at the top level
+    
+    void collectFunctions(std::vector<std::unique_ptr<ASTNode>>& program,
+                          std::vector<FunctionDefNode*>& definitions);
+    void checkFunction(FunctionDefNode* function);
+    void checkReturn(ReturnNode* ret);
+    StaticType checkCall(FunctionCallNode* call);
+    void checkBody(const std::vector<std::unique_ptr<ASTNode>>& body);
+    void checkStatement(ASTNode* stmt);
+    StaticType checkExpression(ASTNode* expr);
+    void checkCondition(ASTNode* condition);
+    void checkAssignable(StaticType target, StaticType value, SymbolId name);
+    void report(DiagnosticKind kind, const std::string& message);
+    
+public:
+    TypeChecker();
+    
+    // signature of a function checked elsewhere (an imported module) that
+    // the program may call; its body is not checked again
+    void importFunction(const FunctionDefNode* function);
+    
+    // returns the diagnostics ordered by line; the program is well-typed if
+    // the result is empty
+    const std::vector<Diagnostic>& check(std::vector<std::unique_ptr<ASTNode>>& program,
+                                         ThreadPool* pool = nullptr);
+};
+
+#endif
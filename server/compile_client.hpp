@@ -0,0 +1,13 @@
+#ifndef COMPILE_CLIENT_HPP
+#define COMPILE_CLIENT_HPP
+
+#include "protocol.hpp"
+#include <string>
+
+// Connected socket to a running compile server, -1 if none is listening.
+int connectToServer(const std::string& socketPath);
+
+// One round trip on a connection from connectToServer().
+bool sendCompileRequest(int fd, const CompileRequest& request, CompileResponse& response);
+
+#endif
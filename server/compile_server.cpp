@@ -0,0 +1,290 @@
+#include "compile_server.hpp"
+#include "../driver/driver.hpp"
+#include "../module/module_loader.hpp"
+#include "../util/interner.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+bool ResultCache::lookup(const std::string& source, CompileResponse& response) {
+    uint64_t hash = fnv1a(source);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto range = index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->source == source) {
+            entries.splice(entries.begin(), entries, it->second);
+            response = it->second->response;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ResultCache::insert(const std::string& source, const CompileResponse& response) {
+    uint64_t hash = fnv1a(source);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto range = index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->source == source) {
+            return;  // another worker compiled the same source first
+        }
+    }
+    
+    Entry entry;
+    entry.source = source;
+    entry.response = response;
+    entries.push_front(std::move(entry));
+    index.insert(std::make_pair(hash, entries.begin()));
+    
+    if (entries.size() > capacity) {
+        auto last = std::prev(entries.end());
+        auto victims = index.equal_range(fnv1a(last->source));
+        for (auto it = victims.first; it != victims.second; ++it) {
+            if (it->second == last) {
+                index.erase(it);
+                break;
+            }
+        }
+        entries.pop_back();
+    }
+}
+
+CompileServer::CompileServer(const std::string& socketPath, size_t threads)
+    : socketPath(socketPath), listenFd(-1), pool(threads),
+      stopping(false), requests(0), cacheHits(0), compiling(0), symbolsResetPending(false) {
+    wakeFds[0] = wakeFds[1] = -1;
+}
+
+const size_t CompileServer::MAX_SYMBOLS;
+const int CompileServer::RECV_TIMEOUT_SECONDS;
+
+CompileServer::~CompileServer() {
+    stop();
+    pool.wait();
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    for (int fd : wakeFds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+bool CompileServer::listen(std::string& error) {
+    // non-blocking both ways: run() drains it, and a full pipe already wakes it
+    if (pipe(wakeFds) < 0 ||
+        fcntl(wakeFds[0], F_SETFL, O_NONBLOCK) < 0 || fcntl(wakeFds[1], F_SETFL, O_NONBLOCK) < 0) {
+        error = std::string("pipe: ") + std::strerror(errno);
+        return false;
+    }
+    
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        error = "Слишком длинный путь к сокету: " + socketPath;
+        return false;
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+    
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    // a socket file left by a crashed server would make bind() fail
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, 64) < 0) {
+        error = "Не удалось открыть сокет " + socketPath + ": " + std::strerror(errno);
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    return true;
+}
+
+static pollfd readable(int fd) {
+    pollfd entry;
+    entry.fd = fd;
+    entry.events = POLLIN;
+    entry.revents = 0;
+    return entry;
+}
+
+void CompileServer::run() {
+    std::vector<int> idle;  // connections waiting for their next request
+    std::vector<pollfd> fds;
+    while (!stopping.load()) {
+        fds.clear();
+        fds.push_back(readable(listenFd));
+        fds.push_back(readable(wakeFds[0]));
+        for (int fd : idle) {
+            fds.push_back(readable(fd));
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        
+        // a closed connection is readable too, its worker finds the end of stream
+        idle.clear();
+        for (size_t i = 2; i < fds.size(); ++i) {
+            int fd = fds[i].fd;
+            if (fds[i].revents) {
+                pool.submit([this, fd]() { serveRequest(fd); });
+            } else {
+                idle.push_back(fd);
+            }
+        }
+        if (fds[1].revents) {
+            char buffer[64];
+            while (read(wakeFds[0], buffer, sizeof(buffer)) > 0) {}
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            idle.insert(idle.end(), returned.begin(), returned.end());
+            returned.clear();
+        }
+        if (fds[0].revents) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                break;  // stop() shut the listening socket down
+            }
+            timeval timeout = {RECV_TIMEOUT_SECONDS, 0};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            connections.insert(fd);
+            idle.push_back(fd);
+        }
+    }
+    
+    stop();
+    pool.wait();
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for (int fd : connections) {
+        close(fd);
+    }
+    connections.clear();
+    returned.clear();
+}
+
+void CompileServer::stop() {
+    if (!stopping.exchange(true) && listenFd >= 0) {
+        shutdown(listenFd, SHUT_RDWR);
+        wake();
+    }
+    // a worker waiting for the rest of a request gives up now
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for (int fd : connections) {
+        shutdown(fd, SHUT_RD);
+    }
+}
+
+void CompileServer::wake() {
+    char byte = 0;
+    ssize_t written = write(wakeFds[1], &byte, 1);
+    (void)written;  // a full pipe wakes run() all the same
+}
+
+void CompileServer::beginCompile() {
+    std::unique_lock<std::mutex> lock(compilingMutex);
+    symbolsReset.wait(lock, [this]() { return !symbolsResetPending; });
+    ++compiling;
+}
+
+// the last compilation to finish resets the interner once it is too big
+void CompileServer::endCompile() {
+    std::lock_guard<std::mutex> lock(compilingMutex);
+    --compiling;
+    if (StringInterner::global().size() > MAX_SYMBOLS) {
+        symbolsResetPending = true;
+    }
+    if (symbolsResetPending && compiling == 0) {
+        StringInterner::global().reset();
+        symbolsResetPending = false;
+        symbolsReset.notify_all();
+    }
+}
+
+// one request of a connection that run() found readable; the connection
+// goes back to run() unless it was closed
+void CompileServer::serveRequest(int fd) {
+    CompileRequest request;
+    bool open = readRequest(fd, request);
+    if (open && request.kind == RequestKind::SHUTDOWN) {
+        writeResponse(fd, CompileResponse());
+        stop();
+        open = false;
+    } else if (open) {
+        open = writeResponse(fd, handle(request));
+    }
+    
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    if (open) {
+        returned.push_back(fd);
+        wake();
+    } else {
+        connections.erase(fd);
+        close(fd);
+    }
+}
+
+CompileResponse CompileServer::handle(const CompileRequest& request) {
+    requests.fetch_add(1, std::memory_order_relaxed);
+    CompileResponse response;
+    
+    std::string source;
+    if (request.kind == RequestKind::SOURCE) {
+        source = request.payload;
+    } else if (request.kind == RequestKind::PATH) {
+        std::ifstream file(request.payload);
+        if (!file.is_open()) {
+            response.status = 1;
+            response.errors = "Не удалось открыть файл " + request.payload + "\n";
+            return response;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        source = buffer.str();
+    } else {
+        response.status = 1;
+        response.errors = "Неизвестный тип запроса\n";
+        return response;
+    }
+    
+    // lexer options change the listing, so they are part of the key
+    std::string key = std::to_string(request.flags) + ":" + source;
+    if (cache.lookup(key, response)) {
+        cacheHits.fetch_add(1, std::memory_order_relaxed);
+        response.cached = true;
+        return response;
+    }
+    
+    std::ostringstream out, err;
+    CompileOptions options;
+    options.lexer.unicodeIdentifiers = (request.flags & REQUEST_UNICODE_IDENTIFIERS) != 0;
+    if (request.kind == RequestKind::PATH) {
+        options.directory = directoryOf(request.payload);
+    }
+    bool hasImports = false;
+    beginCompile();
+    response.status = compileSource(source, out, err, options, &hasImports);
+    endCompile();
+    response.output = out.str();
+    response.errors = err.str();
+    // the result also depends on the imported modules, which the key does
+    // not cover; such programs are compiled every time (the modules
+    // themselves come from their interface files)
+    if (!hasImports) {
+        cache.insert(key, response);
+    }
+    return response;
+}
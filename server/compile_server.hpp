@@ -0,0 +1,96 @@
+#ifndef COMPILE_SERVER_HPP
+#define COMPILE_SERVER_HPP
+
+#include "protocol.hpp"
+#include "../util/hash.hpp"
+#include "../util/thread_pool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// LRU map from request (source text and options) to the finished response. The pipeline is
+// deterministic, so a cached listing is exactly what a recompile would print.
+class ResultCache {
+private:
+    struct Entry {
+        std::string source;
+        CompileResponse response;
+    };
+    
+    size_t capacity;
+    std::list<Entry> entries;  // most recently used first
+    std::unordered_multimap<uint64_t, std::list<Entry>::iterator> index;
+    std::mutex mutex;
+    
+public:
+    explicit ResultCache(size_t capacity = 256) : capacity(capacity) {}
+    
+    bool lookup(const std::string& source, CompileResponse& response);
+    void insert(const std::string& source, const CompileResponse& response);
+};
+
+// Long-lived compiler process: accepts connections on a Unix domain socket
+// and compiles on a thread pool. Interned symbols, the heap and the result
+// cache stay warm between requests.
+//
+// run() polls the idle connections and gives a worker one request at a
+// time, so clients that keep a connection open between requests hold no
+// thread. A client that stops sending in the middle of a request gives its
+// worker back after RECV_TIMEOUT_SECONDS.
+//
+// Every identifier a request brings stays interned, so the interner grows
+// with the number of distinct names ever seen. Past MAX_SYMBOLS it is reset
+// once the compilations in progress are done: nothing kept between requests
+// (cached responses, interface files) holds symbol ids.
+class CompileServer {
+private:
+    static const size_t MAX_SYMBOLS = size_t(1) << 20;
+    static const int RECV_TIMEOUT_SECONDS = 10;
+    
+    std::string socketPath;
+    int listenFd;
+    ThreadPool pool;
+    ResultCache cache;
+    std::atomic<bool> stopping;
+    std::atomic<size_t> requests;
+    std::atomic<size_t> cacheHits;
+    std::set<int> connections;  // open client sockets, closed by stop()
+    std::vector<int> returned;  // connections a worker is done with, polled again by run()
+    std::mutex connectionsMutex;
+    int wakeFds[2];             // pipe that wakes run() when a connection is returned
+    size_t compiling;           // compilations in progress
+    bool symbolsResetPending;   // new compilations wait until the reset is done
+    std::mutex compilingMutex;
+    std::condition_variable symbolsReset;
+    
+    void beginCompile();
+    void endCompile();
+    void wake();
+    void serveRequest(int fd);
+    CompileResponse handle(const CompileRequest& request);
+    
+public:
+    // threads == 0 uses std::thread::hardware_concurrency()
+    CompileServer(const std::string& socketPath, size_t threads = 0);
+    ~CompileServer();
+    
+    CompileServer(const CompileServer&) = delete;
+    CompileServer& operator=(const CompileServer&) = delete;
+    
+    // binds the socket; false with a message in error on failure
+    bool listen(std::string& error);
+    // accept loop, returns after a SHUTDOWN request or stop()
+    void run();
+    void stop();
+    
+    size_t requestCount() const { return requests.load(); }
+    size_t cacheHitCount() const { return cacheHits.load(); }
+};
+
+#endif
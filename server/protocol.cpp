@@ -0,0 +1,90 @@
+#include "protocol.hpp"
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+struct RequestHeader {
+    uint32_t kind;
+    uint32_t flags;
+    uint64_t length;
+};
+
+struct ResponseHeader {
+    int32_t status;
+    uint32_t cached;
+    uint64_t outputLength;
+    uint64_t errorsLength;
+};
+
+// payloads above this are treated as a broken stream
+static const uint64_t MAX_PAYLOAD = uint64_t(1) << 30;
+
+static bool writeAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        // MSG_NOSIGNAL: a client that went away must not kill the server
+        ssize_t written = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+static bool readAll(int fd, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t got = recv(fd, bytes, size, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        bytes += got;
+        size -= got;
+    }
+    return true;
+}
+
+static bool readString(int fd, uint64_t length, std::string& out) {
+    if (length > MAX_PAYLOAD) {
+        return false;
+    }
+    out.resize(length);
+    return length == 0 || readAll(fd, &out[0], length);
+}
+
+bool writeRequest(int fd, const CompileRequest& request) {
+    RequestHeader header = {static_cast<uint32_t>(request.kind), request.flags, request.payload.size()};
+    return writeAll(fd, &header, sizeof(header)) &&
+           writeAll(fd, request.payload.data(), request.payload.size());
+}
+
+bool readRequest(int fd, CompileRequest& request) {
+    RequestHeader header;
+    if (!readAll(fd, &header, sizeof(header))) {
+        return false;
+    }
+    request.kind = static_cast<RequestKind>(header.kind);
+    request.flags = header.flags;
+    return readString(fd, header.length, request.payload);
+}
+
+bool writeResponse(int fd, const CompileResponse& response) {
+    ResponseHeader header = {response.status, response.cached ? 1u : 0u,
+                             response.output.size(), response.errors.size()};
+    return writeAll(fd, &header, sizeof(header)) &&
+           writeAll(fd, response.output.data(), response.output.size()) &&
+           writeAll(fd, response.errors.data(), response.errors.size());
+}
+
+bool readResponse(int fd, CompileResponse& response) {
+    ResponseHeader header;
+    if (!readAll(fd, &header, sizeof(header))) {
+        return false;
+    }
+    response.status = header.status;
+    response.cached = header.cached != 0;
+    return readString(fd, header.outputLength, response.output) &&
+           readString(fd, header.errorsLength, response.errors);
+}
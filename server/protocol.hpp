@@ -0,0 +1,44 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstdint>
+#include <string>
+
+// Wire format between `compiler --client` and `compiler --serve` over a Unix
+// socket: a fixed binary header followed by the payload(s). Several requests
+// may be sent over one connection.
+
+enum class RequestKind : uint32_t {
+    PATH = 1,      // payload is an absolute path readable by the server
+    SOURCE = 2,    // payload is the source text itself
+    SHUTDOWN = 3,  // stop accepting connections
+};
+
+// CompileRequest::flags
+const uint32_t REQUEST_UNICODE_IDENTIFIERS = 1;
+
+struct CompileRequest {
+    RequestKind kind;
+    std::string payload;
+    uint32_t flags;
+    
+    CompileRequest() : kind(RequestKind::SOURCE), flags(0) {}
+    CompileRequest(RequestKind k, const std::string& p, uint32_t f = 0)
+        : kind(k), payload(p), flags(f) {}
+};
+
+struct CompileResponse {
+    int32_t status;
+    bool cached;         // served from the result cache
+    std::string output;  // what the CLI prints to stdout
+    std::string errors;  // what the CLI prints to stderr
+    
+    CompileResponse() : status(0), cached(false) {}
+};
+
+bool writeRequest(int fd, const CompileRequest& request);
+bool readRequest(int fd, CompileRequest& request);
+bool writeResponse(int fd, const CompileResponse& response);
+bool readResponse(int fd, CompileResponse& response);
+
+#endif
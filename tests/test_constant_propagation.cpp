@@ -0,0 +1,91 @@
+// Constant propagation: what SCCP and dead-code elimination rewrite each
+// program to, and that the program prints the expected output before and after.
+// g++ -std=c++11 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp optimizer/*.cpp interpreter/*.cpp tests/test_constant_propagation.cpp -o test_constant_propagation
+#include "../optimizer/constant_propagation.hpp"
+#include "../lexer/lexer.hpp"
+#include "../interpreter/interpreter.hpp"
+#include <iostream>
+#include <sstream>
+
+struct Case {
+    const char* code;
+    const char* optimized;  // the program after the pass, one statement per line
+    int folded;
+    int branchesResolved;
+    const char* output;
+};
+
+static std::string dump(const StatementList& program) {
+    std::string result;
+    for (const auto& stmt : program) {
+        result += stmt->toString();
+        result += "\n";
+    }
+    return result;
+}
+
+static std::string run(const StatementList& program) {
+    std::ostringstream out;
+    try {
+        Interpreter interpreter(out);
+        interpreter.run(program);
+    } catch (const std::exception& e) {
+        out << "Ошибка: " << e.what() << "\n";
+    }
+    return out.str();
+}
+
+int main() {
+    const Case cases[] = {
+        // y = 6 decides the branch, then x and y are no longer read
+        {"int x = 2;\nint y = x * 3;\nif (y > 5) {\n    print(y);\n} else {\n    print(0);\n}\n",
+         "Call(print, [Number(6)])\n",
+         1, 1, "6\n"},
+        // i changes in the loop and stays, the bound n is a constant
+        {"int i = 0;\nint n = 4;\nwhile (i < n) {\n    i = i + 1;\n}\nprint(i);\n",
+         "VarDecl(int i = Number(0))\n"
+         "While((Identifier(i) < Number(4)))\n"
+         "    Assignment(i = (Identifier(i) + Number(1)))\n"
+         "Call(print, [Identifier(i)])\n",
+         0, 0, "4\n"},
+        // b = a + 1 is overwritten before anyone reads it
+        {"int a = 1;\nint b = 0;\nb = a + 1;\nb = 5;\nprint(b);\n",
+         "Call(print, [Number(5)])\n",
+         1, 0, "5\n"},
+        // a loop whose condition is false on entry never runs
+        {"string s = \"a\" + \"b\";\nbool f = false;\nwhile (f) {\n    print(s);\n}\nprint(s);\n",
+         "Call(print, [String(\"ab\")])\n",
+         1, 1, "ab\n"},
+    };
+
+    int failures = 0;
+    int count = sizeof(cases) / sizeof(cases[0]);
+    for (const Case& test : cases) {
+        Lexer original(test.code);
+        Parser originalParser(original.tokensize());
+        StatementList reference = originalParser.parse();
+        std::string originalOutput = run(reference);
+
+        Lexer lexer(test.code);
+        Parser parser(lexer.tokensize());
+        StatementList program = parser.parse();
+        ConstantPropagator propagator;
+        ConstPropStats stats = propagator.run(program);
+        std::string optimized = dump(program);
+        std::string output = run(program);
+
+        if (optimized != test.optimized || stats.folded != test.folded ||
+            stats.branchesResolved != test.branchesResolved ||
+            originalOutput != test.output || output != test.output) {
+            std::cout << "FAIL\n" << test.code
+                      << "--- ожидалось (свёрнуто " << test.folded
+                      << ", ветвлений " << test.branchesResolved << "):\n" << test.optimized << test.output
+                      << "--- получено (свёрнуто " << stats.folded
+                      << ", ветвлений " << stats.branchesResolved << "):\n" << optimized << output
+                      << "--- без оптимизации:\n" << originalOutput;
+            failures++;
+        }
+    }
+    std::cout << count - failures << " из " << count << " программ оптимизированы верно" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
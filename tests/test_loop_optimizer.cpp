@@ -0,0 +1,143 @@
+// Loop optimizer: what LICM and strength reduction rewrite each program to,
+// and that the program prints the expected output before and after.
+// g++ -std=c++11 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp optimizer/*.cpp interpreter/*.cpp tests/test_loop_optimizer.cpp -o test_loop_optimizer
+#include "../optimizer/loop_optimizer.hpp"
+#include "../lexer/lexer.hpp"
+#include "../interpreter/interpreter.hpp"
+#include <iostream>
+#include <sstream>
+
+struct Case {
+    const char* code;
+    const char* optimized;  // the program after the pass, one statement per line
+    int hoisted;
+    int strengthReduced;
+    const char* output;
+};
+
+#define ZEROS_10 "0000000000"
+#define ZEROS_100 ZEROS_10 ZEROS_10 ZEROS_10 ZEROS_10 ZEROS_10 ZEROS_10 ZEROS_10 ZEROS_10 ZEROS_10 ZEROS_10
+// 1e310, past the range of double
+#define HUGE_FLOAT "1" ZEROS_100 ZEROS_100 ZEROS_100 ZEROS_10 ".0"
+
+static std::string dump(const StatementList& program) {
+    std::string result;
+    for (const auto& stmt : program) {
+        result += stmt->toString();
+        result += "\n";
+    }
+    return result;
+}
+
+static std::string run(const StatementList& program) {
+    std::ostringstream out;
+    try {
+        Interpreter interpreter(out);
+        interpreter.run(program);
+    } catch (const std::exception& e) {
+        out << "Ошибка: " << e.what() << "\n";
+    }
+    return out.str();
+}
+
+int main() {
+    const Case cases[] = {
+        // a * b reads nothing the loop writes
+        {"int a = 3;\nint b = 4;\nint i = 0;\nint s = 0;\n"
+         "while (i < 10) {\n    s = s + a * b;\n    i = i + 1;\n}\nprint(s);\n",
+         "VarDecl(int a = Number(3))\n"
+         "VarDecl(int b = Number(4))\n"
+         "VarDecl(int i = Number(0))\n"
+         "VarDecl(int s = Number(0))\n"
+         "VarDecl(int __licm0 = (Identifier(a) * Identifier(b)))\n"
+         "While((Identifier(i) < Number(10)))\n"
+         "    Assignment(s = (Identifier(s) + Identifier(__licm0)))\n"
+         "    Assignment(i = (Identifier(i) + Number(1)))\n"
+         "Call(print, [Identifier(s)])\n",
+         1, 0, "120\n"},
+        // i * 3 with step 2 becomes a temporary advanced by 6
+        {"int i = 0;\nint s = 0;\n"
+         "while (i < 5) {\n    s = s + i * 3;\n    i = i + 2;\n}\nprint(s);\n",
+         "VarDecl(int i = Number(0))\n"
+         "VarDecl(int s = Number(0))\n"
+         "VarDecl(int __sr0 = (Identifier(i) * Number(3)))\n"
+         "While((Identifier(i) < Number(5)))\n"
+         "    Assignment(s = (Identifier(s) + Identifier(__sr0)))\n"
+         "    Assignment(i = (Identifier(i) + Number(2)))\n"
+         "    Assignment(__sr0 = (Identifier(__sr0) + Number(6)))\n"
+         "Call(print, [Identifier(s)])\n",
+         0, 1, "18\n"},
+        // the guard is hoisted, the division it protects may fail and stays
+        {"int d = 0;\nint i = 0;\nint s = 0;\n"
+         "while (i < 3) {\n    if (d != 0) {\n        s = s + 10 / d;\n    }\n    i = i + 1;\n}\nprint(s);\n",
+         "VarDecl(int d = Number(0))\n"
+         "VarDecl(int i = Number(0))\n"
+         "VarDecl(int s = Number(0))\n"
+         "VarDecl(bool __licm0 = (Identifier(d) != Number(0)))\n"
+         "While((Identifier(i) < Number(3)))\n"
+         "    If(Identifier(__licm0))\n"
+         "  Then: \n"
+         "    Assignment(s = (Identifier(s) + (Number(10) / Identifier(d))))\n"
+         "    Assignment(i = (Identifier(i) + Number(1)))\n"
+         "Call(print, [Identifier(s)])\n",
+         1, 0, "0\n"},
+        // a is written in the loop and i is not multiplied: nothing to do
+        {"int a = 1;\nint i = 0;\n"
+         "while (i < 3) {\n    print(a * 2);\n    a = a + i;\n    i = i + 1;\n}\n",
+         "VarDecl(int a = Number(1))\n"
+         "VarDecl(int i = Number(0))\n"
+         "While((Identifier(i) < Number(3)))\n"
+         "    Call(print, [(Identifier(a) * Number(2))])\n"
+         "    Assignment(a = (Identifier(a) + Identifier(i)))\n"
+         "    Assignment(i = (Identifier(i) + Number(1)))\n",
+         0, 0, "2\n2\n4\n"},
+        // literals past the int and double ranges wrap and saturate like the runtime
+        {"int i = 0;\nfloat f = 0.0;\nint s = 0;\n"
+         "while (i < 3) {\n    f = f + 2.0 / " HUGE_FLOAT ";\n    s = s + i * 99999999999999999999;\n"
+         "    i = i + 4294967297;\n}\nprint(s);\nprint(f);\n",
+         "VarDecl(int i = Number(0))\n"
+         "VarDecl(float f = Number(0.0))\n"
+         "VarDecl(int s = Number(0))\n"
+         "VarDecl(int __sr0 = (Identifier(i) * Number(1661992959)))\n"
+         "VarDecl(float __licm1 = (Number(2.0) / Number(" HUGE_FLOAT ")))\n"
+         "While((Identifier(i) < Number(3)))\n"
+         "    Assignment(f = (Identifier(f) + Identifier(__licm1)))\n"
+         "    Assignment(s = (Identifier(s) + Identifier(__sr0)))\n"
+         "    Assignment(i = (Identifier(i) + Number(4294967297)))\n"
+         "    Assignment(__sr0 = (Identifier(__sr0) + Number(1661992959)))\n"
+         "Call(print, [Identifier(s)])\n"
+         "Call(print, [Identifier(f)])\n",
+         1, 1, "691011581\n0\n"},
+    };
+
+    int failures = 0;
+    int count = sizeof(cases) / sizeof(cases[0]);
+    for (const Case& test : cases) {
+        Lexer original(test.code);
+        Parser originalParser(original.tokensize());
+        StatementList reference = originalParser.parse();
+        std::string originalOutput = run(reference);
+
+        Lexer lexer(test.code);
+        Parser parser(lexer.tokensize());
+        StatementList program = parser.parse();
+        LoopOptimizer optimizer;
+        LoopOptStats stats = optimizer.run(program);
+        std::string optimized = dump(program);
+        std::string output = run(program);
+
+        if (optimized != test.optimized || stats.hoisted != test.hoisted ||
+            stats.strengthReduced != test.strengthReduced ||
+            originalOutput != test.output || output != test.output) {
+            std::cout << "FAIL\n" << test.code
+                      << "--- ожидалось (вынесено " << test.hoisted
+                      << ", снижено " << test.strengthReduced << "):\n" << test.optimized << test.output
+                      << "--- получено (вынесено " << stats.hoisted
+                      << ", снижено " << stats.strengthReduced << "):\n" << optimized << output
+                      << "--- без оптимизации:\n" << originalOutput;
+            failures++;
+        }
+    }
+    std::cout << count - failures << " из " << count << " программ оптимизированы верно" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
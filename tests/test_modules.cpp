@@ -0,0 +1,103 @@
+// Module imports: interface files are reused while nothing a module depends
+// on has changed, rebuilt when it has, and a damaged one is parsed around.
+// g++ -std=c++11 -pthread lexer/lexer.cpp parser/pars.cpp semantic/*.cpp util/*.cpp optimizer/*.cpp module/*.cpp interpreter/*.cpp instrument/*.cpp driver/*.cpp tests/test_modules.cpp -o test_modules
+#include "../driver/driver.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+static std::string directory;
+
+static void writeFile(const std::string& name, const std::string& text) {
+    std::ofstream file(directory + "/" + name, std::ios::binary);
+    file << text;
+}
+
+static std::string readFile(const std::string& name) {
+    std::ifstream file(directory + "/" + name, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+struct Result {
+    int status;
+    long cached;         // modules loaded from interface files, -1 if none were loaded
+    std::string output;  // what the program printed
+};
+
+static Result compile(const std::string& code) {
+    CompileOptions options;
+    options.directory = directory;
+    std::ostringstream out, err;
+    Result result;
+    result.status = compileSource(code, out, err, options);
+    std::string listing = out.str();
+    size_t cached = listing.find("из кэша: ");
+    result.cached = cached == std::string::npos
+        ? -1 : std::strtol(listing.c_str() + cached + std::string("из кэша: ").size(), nullptr, 10);
+    size_t run = listing.find("--- ВЫПОЛНЕНИЕ ---\n");
+    result.output = run == std::string::npos ? "" : listing.substr(run + std::string("--- ВЫПОЛНЕНИЕ ---\n").size());
+    result.output += err.str();
+    return result;
+}
+
+int main() {
+    char pattern[] = "/tmp/test_modules.XXXXXX";
+    if (!mkdtemp(pattern)) {
+        std::cout << "Не удалось создать временный каталог" << std::endl;
+        return 1;
+    }
+    directory = pattern;
+
+    // the int stored into d becomes an IntToFloat conversion, which the
+    // interface file has to keep
+    writeFile("base.txt", "int step() {\n    return 2;\n}\n");
+    writeFile("lib.txt", "import \"base.txt\";\n"
+                         "float half(float x) {\n    float d = step();\n    return x / d;\n}\n");
+    const std::string program = "import \"lib.txt\";\nprint(half(3));\n";
+
+    struct Step {
+        const char* what;
+        void (*change)();
+        long cached;
+        const char* output;
+    };
+    const Step steps[] = {
+        {"первая компиляция", [] {}, 0, "1.5\n"},
+        {"ничего не изменилось", [] {}, 2, "1.5\n"},
+        // a changed dependency invalidates its importers too
+        {"изменился base.txt", [] { writeFile("base.txt", "int step() {\n    return 4;\n}\n"); },
+         0, "0.75\n"},
+        {"после перекомпиляции", [] {}, 2, "0.75\n"},
+        {"испорчен lib.txt.iface", [] {
+             std::string iface = readFile("lib.txt.iface");
+             iface[iface.size() / 2] ^= 0x5a;
+             writeFile("lib.txt.iface", iface);
+         }, 1, "0.75\n"},
+        {"обрезан lib.txt.iface", [] { writeFile("lib.txt.iface", "CMI"); }, 1, "0.75\n"},
+        {"файлы восстановлены", [] {}, 2, "0.75\n"},
+    };
+
+    int failures = 0;
+    int count = sizeof(steps) / sizeof(steps[0]);
+    for (const Step& step : steps) {
+        step.change();
+        Result result = compile(program);
+        if (result.status != 0 || result.cached != step.cached || result.output != step.output) {
+            std::cout << "FAIL " << step.what << ": ожидалось из кэша " << step.cached << ", "
+                      << step.output << "--- получено (код " << result.status << ") из кэша "
+                      << result.cached << ", " << result.output << std::endl;
+            failures++;
+        }
+    }
+
+    for (const char* name : {"base.txt", "base.txt.iface", "lib.txt", "lib.txt.iface"}) {
+        unlink((directory + "/" + name).c_str());
+    }
+    rmdir(directory.c_str());
+    std::cout << count - failures << " из " << count << " шагов верны" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
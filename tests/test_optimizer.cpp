@@ -0,0 +1,85 @@
+// Differential test: every program must print the same output and fail with
+// the same error with and without the optimizer passes, and print the
+// expected output where one is given.
+// g++ -std=c++11 -pthread lexer/lexer.cpp parser/pars.cpp semantic/*.cpp util/*.cpp optimizer/*.cpp interpreter/*.cpp tests/test_optimizer.cpp -o test_optimizer
+#include "../optimizer/program_passes.hpp"
+#include "../lexer/lexer.hpp"
+#include "../semantic/type_checker.hpp"
+#include "../interpreter/interpreter.hpp"
+#include <iostream>
+#include <sstream>
+
+// program output followed by the error, if any
+static std::string runProgram(const std::string& code, bool optimize) {
+    Lexer lexer(code);
+    Parser parser(lexer.tokensize());
+    StatementList program = parser.parse();
+    TypeChecker checker;
+    if (!checker.check(program).empty()) {
+        return "ошибки типов";
+    }
+    if (optimize) {
+        propagateConstants(program);
+        optimizeLoops(program);
+    }
+    std::ostringstream out;
+    try {
+        Interpreter interpreter(out);
+        interpreter.run(program);
+    } catch (const RuntimeError& e) {
+        out << "Ошибка в строке " << e.line() << ": " << e.what() << "\n";
+    }
+    return out.str();
+}
+
+struct Case {
+    const char* code;
+    const char* expected;  // nullptr: only the two runs are compared
+};
+
+int main() {
+    const Case cases[] = {
+        // unused values whose computation fails
+        {"int d = 0;\nint y = 5 / d;\nprint(\"after\");\n", nullptr},
+        {"int d = 0;\nint y = 1;\ny = 7 / d;\nprint(\"after\");\n", nullptr},
+        {"int d = 0;\n10 / d;\nprint(\"after\");\n", nullptr},
+        {"int d = 0;\nif (1 / d > 0) {\n}\nprint(\"after\");\n", nullptr},
+        {"int k(int a) {\n    int unused = 10 / a;\n    return 1;\n}\nprint(k(0));\n", nullptr},
+        // nonzero constant divisors still let dead code go
+        {"int d = 2;\nint y = 5 / d;\nint z = 5 / 2;\nprint(\"after\");\n", "after\n"},
+        {"int i = 0;\nint s = 0;\nwhile (i < 4) {\n    s = s + 12 / (i - 2);\n    i = i + 1;\n}\nprint(s);\n",
+         nullptr},
+        // an int stored as a float is a float from then on
+        {"float f = 1;\nprint(f / 2);\n", "0.5\n"},
+        {"int n = 3;\nfloat f = 0.0;\nf = n;\nprint(f / 2);\n", "1.5\n"},
+        {"float half(float x) {\n    return x / 2;\n}\nprint(half(3));\n", "1.5\n"},
+        {"float one() {\n    return 1;\n}\nprint(one() / 4);\n", "0.25\n"},
+        {"int i = 0;\nfloat s = 0.0;\nwhile (i < 3) {\n    float t = i;\n    s = s + t / 2;\n    i = i + 1;\n}\nprint(s);\n",
+         "1.5\n"},
+        // functions: recursion, locals that are not the caller's, unbounded depth
+        {"int fib(int n) {\n    if (n < 2) {\n        return n;\n    }\n    return fib(n - 1) + fib(n - 2);\n}\n"
+         "print(fib(15));\n",
+         "610\n"},
+        {"int twice(int n) {\n    int i = n * 2;\n    return i;\n}\nint i = 5;\nprint(twice(i + 1));\nprint(i);\n",
+         "12\n5\n"},
+        {"int down(int n) {\n    return down(n + 1);\n}\nprint(\"before\");\nprint(down(0));\n", nullptr},
+    };
+
+    int failures = 0;
+    int count = sizeof(cases) / sizeof(cases[0]);
+    for (const Case& test : cases) {
+        std::string plain = runProgram(test.code, false);
+        std::string optimized = runProgram(test.code, true);
+        if (plain != optimized || (test.expected && plain != test.expected)) {
+            std::cout << "FAIL\n" << test.code;
+            if (test.expected) {
+                std::cout << "--- ожидалось:\n" << test.expected;
+            }
+            std::cout << "--- без оптимизаций:\n" << plain
+                      << "--- с оптимизациями:\n" << optimized << std::endl;
+            failures++;
+        }
+    }
+    std::cout << count - failures << " из " << count << " программ совпали" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
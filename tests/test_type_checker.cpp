@@ -0,0 +1,100 @@
+// Type checker: programs that must be rejected with a given diagnostic, and
+// programs that must pass.
+// g++ -std=c++11 -pthread lexer/lexer.cpp parser/pars.cpp semantic/*.cpp util/*.cpp tests/test_type_checker.cpp -o test_type_checker
+#include "../lexer/lexer.hpp"
+#include "../semantic/type_checker.hpp"
+#include <iostream>
+
+struct Case {
+    const char* code;
+    bool wellTyped;
+    DiagnosticKind kind;  // the first diagnostic when not well-typed
+};
+
+int main() {
+    const Case cases[] = {
+        {"print(y);\n", false, DiagnosticKind::UNDECLARED_VARIABLE},
+        {"int x = 1;\nint x = 2;\n", false, DiagnosticKind::REDECLARED_VARIABLE},
+        {"int x = 1;\nshow(x);\n", false, DiagnosticKind::UNKNOWN_FUNCTION},
+        {"int x = \"a\";\n", false, DiagnosticKind::TYPE_MISMATCH},
+        {"float f = 1.5;\nbool b = true;\nb = f;\n", false, DiagnosticKind::TYPE_MISMATCH},
+        {"string s = \"a\";\nprint(s * 2);\n", false, DiagnosticKind::INVALID_OPERANDS},
+        {"int x = 1;\nif (x) {\n    print(x);\n}\n", false, DiagnosticKind::NON_BOOL_CONDITION},
+        // a variable is visible only in its own block and the ones inside it
+        {"bool c = true;\nif (c) {\n    int t = 1;\n}\nprint(t);\n", false, DiagnosticKind::UNDECLARED_VARIABLE},
+        {"int i = 0;\nfloat s = 0.5;\nwhile (i < 3) {\n    s = s * 2.0 + i;\n    i = i + 1;\n}\n"
+         "string m = \"s=\";\nprint(m);\nprint(s > 1.0);\n",
+         true, DiagnosticKind::TYPE_MISMATCH},
+        // an inner declaration would overwrite the outer variable at run time
+        {"int x = 1;\nif (x == 1) {\n    string x = \"a\";\n}\nprint(x + 1);\n",
+         false, DiagnosticKind::REDECLARED_VARIABLE},
+        {"int x = 1;\nif (x == 1) {\n    int x = 5;\n}\nprint(x);\n",
+         false, DiagnosticKind::REDECLARED_VARIABLE},
+        {"int x = 1;\nwhile (x < 3) {\n    {\n        int x = 0;\n    }\n    x = x + 1;\n}\n",
+         false, DiagnosticKind::REDECLARED_VARIABLE},
+        // a name whose scope has ended may be declared again
+        {"int x = 1;\nif (x == 1) {\n    int t = 1;\n}\nif (x == 1) {\n    string t = \"a\";\n}\nint t = 2;\nprint(t);\n",
+         true, DiagnosticKind::REDECLARED_VARIABLE},
+        {"int f(int a) {\n    if (a > 0) {\n        int a = 2;\n    }\n    return a;\n}\nprint(f(1));\n",
+         false, DiagnosticKind::REDECLARED_VARIABLE},
+        // functions see their parameters and locals, not the top-level variables
+        {"int x = 1;\nint f() {\n    int x = 2;\n    return x;\n}\nprint(f() + x);\n",
+         true, DiagnosticKind::REDECLARED_VARIABLE},
+        {"int x = 1;\nint f() {\n    return x;\n}\nprint(f());\n",
+         false, DiagnosticKind::UNDECLARED_VARIABLE},
+        {"int f(int a) {\n    return a;\n}\nfloat f(float a) {\n    return a;\n}\n",
+         false, DiagnosticKind::REDECLARED_FUNCTION},
+        {"int f(int a) {\n    return a;\n}\nprint(f(1, 2));\n", false, DiagnosticKind::ARGUMENT_MISMATCH},
+        {"int f(int a) {\n    return a;\n}\nprint(f(\"a\"));\n", false, DiagnosticKind::ARGUMENT_MISMATCH},
+        {"int f(int a) {\n    return \"a\";\n}\nprint(f(1));\n", false, DiagnosticKind::RETURN_MISMATCH},
+        {"int f(int a) {\n    if (a > 0) {\n        return 1;\n    }\n}\nprint(f(1));\n",
+         false, DiagnosticKind::MISSING_RETURN},
+        // both branches return; recursion and calls before the definition are fine
+        {"int fib(int n) {\n    if (n < 2) {\n        return n;\n    } else {\n        return fib(n - 1) + fib(n - 2);\n    }\n}\n"
+         "print(fib(10));\n",
+         true, DiagnosticKind::MISSING_RETURN},
+        {"print(half(3));\nfloat half(float x) {\n    return x / 2;\n}\n", true, DiagnosticKind::TYPE_MISMATCH},
+    };
+
+    int failures = 0;
+    int count = sizeof(cases) / sizeof(cases[0]);
+    for (const Case& test : cases) {
+        Lexer lexer(test.code);
+        Parser parser(lexer.tokensize());
+        std::vector<std::unique_ptr<ASTNode>> program = parser.parse();
+        TypeChecker checker;
+        const std::vector<Diagnostic>& diagnostics = checker.check(program);
+        bool passed = test.wellTyped
+            ? diagnostics.empty()
+            : !diagnostics.empty() && diagnostics[0].kind == test.kind;
+        if (!passed) {
+            std::cout << "FAIL\n" << test.code << "--- ожидалось: "
+                      << (test.wellTyped ? "без ошибок" : diagnosticKindName(test.kind))
+                      << "\n--- получено:\n";
+            printDiagnostics(diagnostics, std::cout);
+            failures++;
+        }
+    }
+    
+    // a diagnostic names the statement without its body
+    const char* contextCases[][2] = {
+        {"int f(int a) {\n    int b = a + 1;\n    if (a > 0) {\n        return b;\n    }\n}\n",
+         "Function(int f(int a))"},
+        {"int x = 1;\nif (x) {\n    print(x);\n    x = x + 1;\n}\n", "If(Identifier(x))"},
+    };
+    for (const auto& test : contextCases) {
+        count++;
+        Lexer lexer(test[0]);
+        Parser parser(lexer.tokensize());
+        std::vector<std::unique_ptr<ASTNode>> program = parser.parse();
+        TypeChecker checker;
+        const std::vector<Diagnostic>& diagnostics = checker.check(program);
+        if (diagnostics.empty() || diagnostics[0].context != test[1]) {
+            std::cout << "FAIL\n" << test[0] << "--- ожидалось: в " << test[1] << "\n--- получено:\n";
+            printDiagnostics(diagnostics, std::cout);
+            failures++;
+        }
+    }
+    std::cout << count - failures << " из " << count << " программ проверены верно" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
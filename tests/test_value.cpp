@@ -0,0 +1,51 @@
+// Runtime comparisons: floats follow IEEE 754, so NaN is unordered and
+// unequal to everything, itself included.
+// g++ -std=c++11 -pthread lexer/lexer.cpp parser/pars.cpp util/*.cpp interpreter/*.cpp tests/test_value.cpp -o test_value
+#include "../interpreter/value.hpp"
+#include <iostream>
+#include <limits>
+
+struct Case {
+    Value left;
+    const char* op;
+    Value right;
+    bool expected;
+};
+
+int main() {
+    Value nan = Value::makeFloat(std::numeric_limits<double>::quiet_NaN());
+    Value inf = Value::makeFloat(std::numeric_limits<double>::infinity());
+    Value one = Value::makeFloat(1.0);
+    Value two = Value::makeInt(2);
+    const Case cases[] = {
+        {nan, "==", nan, false},
+        {nan, "!=", nan, true},
+        {nan, "<", one, false},
+        {nan, ">", one, false},
+        {nan, "<=", nan, false},
+        {nan, ">=", nan, false},
+        {one, "==", nan, false},
+        {two, "!=", nan, true},
+        {two, ">=", nan, false},
+        {one, "<=", one, true},
+        {one, "<", inf, true},
+        {inf, ">=", inf, true},
+        {two, "==", Value::makeFloat(2.0), true},
+        {two, ">", one, true},
+    };
+
+    int failures = 0;
+    int count = sizeof(cases) / sizeof(cases[0]);
+    for (const Case& test : cases) {
+        std::string result = applyBinaryOp(test.op, test.left, test.right).toString();
+        std::string expected = test.expected ? "true" : "false";
+        if (result != expected) {
+            std::cout << "FAIL " << test.left.toString() << " " << test.op << " "
+                      << test.right.toString() << ": ожидалось " << expected
+                      << ", получено " << result << std::endl;
+            failures++;
+        }
+    }
+    std::cout << count - failures << " из " << count << " сравнений верны" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstddef>
+
+// Counts global operator new calls. Linking alloc_counter.cpp replaces the
+// global operator new/delete; the counters are relaxed atomics, skipped
+// entirely while counting is switched off.
+struct AllocStats {
+    size_t allocations;
+    size_t bytes;
+};
+
+AllocStats allocStats();
+void setAllocCounting(bool enabled);  // on by default
+
+// peak resident set size in KiB; resetPeakRss() restarts the measurement
+// where the kernel supports it (Linux /proc/self/clear_refs)
+size_t peakRssKb();
+void resetPeakRss();
+
+#endif
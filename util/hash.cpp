@@ -0,0 +1,14 @@
+#include "hash.hpp"
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t fnv1a(const std::string& data, uint64_t hash) {
+    return fnv1a(data.data(), data.size(), hash);
+}
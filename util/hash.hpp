@@ -0,0 +1,14 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+const uint64_t FNV1A_OFFSET = 14695981039346656037ull;
+
+// 64-bit FNV-1a; pass a previous result as hash to continue it over more data
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = FNV1A_OFFSET);
+uint64_t fnv1a(const std::string& data, uint64_t hash = FNV1A_OFFSET);
+
+#endif
@@ -0,0 +1,66 @@
+#include "interner.hpp"
+#include <stdexcept>
+
+StringInterner::StringInterner() : count(0) {
+    for (auto& chunk : chunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+    reset();
+}
+
+StringInterner::~StringInterner() {
+    for (auto& chunk : chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+StringInterner& StringInterner::global() {
+    static StringInterner instance;
+    return instance;
+}
+
+SymbolId StringInterner::intern(const std::string& str) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    auto it = ids.find(str);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    
+    SymbolId id = count.load(std::memory_order_relaxed);
+    size_t chunkIndex = id >> CHUNK_BITS;
+    if (chunkIndex >= MAX_CHUNKS) {
+        throw std::runtime_error("Слишком много идентификаторов");
+    }
+    const std::string** chunk = chunks[chunkIndex].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new const std::string*[CHUNK_SIZE];
+        chunks[chunkIndex].store(chunk, std::memory_order_release);
+    }
+    
+    // node-based map: the key address stays valid on rehash
+    it = ids.insert(std::make_pair(str, id)).first;
+    chunk[id & (CHUNK_SIZE - 1)] = &it->first;
+    count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+void StringInterner::reset() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& chunk : chunks) {
+            delete[] chunk.exchange(nullptr, std::memory_order_relaxed);
+        }
+        ids.clear();
+        count.store(0, std::memory_order_release);
+    }
+    intern("true");
+    intern("false");
+    intern("print");
+}
+
+SymbolId StringInterner::find(const std::string& str) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = ids.find(str);
+    return it == ids.end() ? NO_SYMBOL : it->second;
+}
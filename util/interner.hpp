@@ -0,0 +1,64 @@
+#ifndef INTERNER_HPP
+#define INTERNER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+typedef uint32_t SymbolId;
+
+const SymbolId NO_SYMBOL = 0xFFFFFFFFu;
+
+// pre-interned names, fixed ids in every interner
+const SymbolId SYM_TRUE = 0;
+const SymbolId SYM_FALSE = 1;
+const SymbolId SYM_PRINT = 2;
+
+// Maps each distinct string to a dense 32-bit id 0, 1, 2, ...
+// intern() takes a lock; str() is lock-free: names live in fixed-size chunks
+// that are never moved, and an id is published only after its chunk entry.
+class StringInterner {
+private:
+    static const size_t CHUNK_BITS = 14;
+    static const size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static const size_t MAX_CHUNKS = 1 << 14;  // 2^28 names
+    
+    std::unordered_map<std::string, SymbolId> ids;
+    std::atomic<const std::string**> chunks[MAX_CHUNKS];
+    std::atomic<SymbolId> count;
+    mutable std::mutex mutex;
+    
+public:
+    StringInterner();
+    ~StringInterner();
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+    
+    // process-wide interner shared by Lexer and Parser
+    static StringInterner& global();
+    
+    SymbolId intern(const std::string& str);
+    // id of an already interned string, NO_SYMBOL otherwise
+    SymbolId find(const std::string& str) const;
+    // forgets every name but the pre-interned ones; ids handed out before are
+    // invalid afterwards, so no other thread may use the interner or hold ids
+    void reset();
+    
+    const std::string& str(SymbolId id) const {
+        const std::string** chunk = chunks[id >> CHUNK_BITS].load(std::memory_order_acquire);
+        return *chunk[id & (CHUNK_SIZE - 1)];
+    }
+    size_t size() const { return count.load(std::memory_order_acquire); }
+};
+
+inline SymbolId internSymbol(const std::string& str) {
+    return StringInterner::global().intern(str);
+}
+
+inline const std::string& symbolName(SymbolId id) {
+    return StringInterner::global().str(id);
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <exception>
+
+ThreadPool::ThreadPool(size_t threads) : running(0), stopping(false) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return tasks.empty() && running == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;  // stopping and drained
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            running++;
+        }
+        
+        task();
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+            if (tasks.empty() && running == 0) {
+                idle.notify_all();
+            }
+        }
+    }
+}
+
+void parallelFor(ThreadPool* pool, size_t count, const std::function<void(size_t)>& body) {
+    if (!pool || pool->size() <= 1 || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+    
+    // a few chunks per worker: cheap tasks stay cheap, uneven ones still balance
+    size_t chunks = std::min(count, pool->size() * 4);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        size_t begin = count * chunk / chunks;
+        size_t end = count * (chunk + 1) / chunks;
+        pool->submit([&, begin, end] {
+            try {
+                for (size_t i = begin; i < end; ++i) {
+                    body(i);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+    pool->wait();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
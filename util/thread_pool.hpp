@@ -0,0 +1,43 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads over a FIFO task queue. Tasks must not throw.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskReady;
+    std::condition_variable idle;
+    size_t running;
+    bool stopping;
+    
+    void workerLoop();
+    
+public:
+    // threads == 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();  // finishes queued tasks, then joins
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    void submit(std::function<void()> task);
+    void wait();  // until the queue is empty and no task is running
+    size_t size() const { return workers.size(); }
+};
+
+// Calls body(i) for every i in [0, count), in contiguous chunks on pool, or in
+// order on the calling thread when pool is null. Returns once all calls are
+// done; the first exception a call throws is rethrown here. Waits for the
+// whole pool, so it must not be called from one of its tasks.
+void parallelFor(ThreadPool* pool, size_t count, const std::function<void(size_t)>& body);
+
+#endif
@@ -0,0 +1,141 @@
+#include "utf8.hpp"
+#include <algorithm>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// length of the leading ASCII run
+static size_t asciiPrefix(const char* data, size_t size) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int mask = _mm_movemask_epi8(block);  // high bit of every byte
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#else
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        if (word & 0x8080808080808080ull) {
+            break;
+        }
+    }
+#endif
+    while (i < size && static_cast<unsigned char>(data[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+bool isAscii(const char* data, size_t size) {
+    return asciiPrefix(data, size) == size;
+}
+
+// Length of the well-formed sequence at data, 0 if it is malformed.
+// Second-byte bounds follow the Unicode well-formed byte sequence table.
+static size_t sequenceLength(const unsigned char* data, size_t size) {
+    unsigned char lead = data[0];
+    size_t length;
+    unsigned char low = 0x80, high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) low = 0xA0;        // overlong
+        else if (lead == 0xED) high = 0x9F;  // surrogates
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) low = 0x90;        // overlong
+        else if (lead == 0xF4) high = 0x8F;  // above U+10FFFF
+    } else {
+        return 0;
+    }
+    if (length > size || data[1] < low || data[1] > high) {
+        return 0;
+    }
+    for (size_t i = 2; i < length; ++i) {
+        if ((data[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+size_t findInvalidUtf8(const char* data, size_t size) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    size_t i = 0;
+    while (i < size) {
+        i += asciiPrefix(data + i, size - i);
+        // scalar over the non-ASCII run, back to the vector loop after it
+        while (i < size && bytes[i] >= 0x80) {
+            size_t length = sequenceLength(bytes + i, size - i);
+            if (length == 0) {
+                return i;
+            }
+            i += length;
+        }
+    }
+    return size;
+}
+
+size_t decodeUtf8(const char* data, size_t size, uint32_t& codePoint) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    unsigned char lead = bytes[0];
+    size_t length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+    if (length > size) {
+        codePoint = 0xFFFD;
+        return size;
+    }
+    static const unsigned char leadMask[] = {0, 0x7F, 0x1F, 0x0F, 0x07};
+    codePoint = lead & leadMask[length];
+    for (size_t i = 1; i < length; ++i) {
+        codePoint = (codePoint << 6) | (bytes[i] & 0x3F);
+    }
+    return length;
+}
+
+struct CodePointRange {
+    uint32_t first;
+    uint32_t last;
+};
+
+// C11 Annex D.1: characters allowed in identifiers
+static const CodePointRange identifierRanges[] = {
+    {0x00A8, 0x00A8}, {0x00AA, 0x00AA}, {0x00AD, 0x00AD}, {0x00AF, 0x00AF},
+    {0x00B2, 0x00B5}, {0x00B7, 0x00BA}, {0x00BC, 0x00BE}, {0x00C0, 0x00D6},
+    {0x00D8, 0x00F6}, {0x00F8, 0x00FF}, {0x0100, 0x167F}, {0x1681, 0x180D},
+    {0x180F, 0x1FFF}, {0x200B, 0x200D}, {0x202A, 0x202E}, {0x203F, 0x2040},
+    {0x2054, 0x2054}, {0x2060, 0x206F}, {0x2070, 0x218F}, {0x2460, 0x24FF},
+    {0x2776, 0x2793}, {0x2C00, 0x2DFF}, {0x2E80, 0x2FFF}, {0x3004, 0x3007},
+    {0x3021, 0x302F}, {0x3031, 0x303F}, {0x3040, 0xD7FF}, {0xF900, 0xFD3D},
+    {0xFD40, 0xFDCF}, {0xFDF0, 0xFE44}, {0xFE47, 0xFFFD},
+    {0x10000, 0x1FFFD}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}, {0x40000, 0x4FFFD},
+    {0x50000, 0x5FFFD}, {0x60000, 0x6FFFD}, {0x70000, 0x7FFFD}, {0x80000, 0x8FFFD},
+    {0x90000, 0x9FFFD}, {0xA0000, 0xAFFFD}, {0xB0000, 0xBFFFD}, {0xC0000, 0xCFFFD},
+    {0xD0000, 0xDFFFD}, {0xE0000, 0xEFFFD},
+};
+
+// C11 Annex D.2: combining marks, not allowed as the first character
+static const CodePointRange combiningRanges[] = {
+    {0x0300, 0x036F}, {0x1DC0, 0x1DFF}, {0x20D0, 0x20FF}, {0xFE20, 0xFE2F},
+};
+
+template <size_t N>
+static bool inRanges(const CodePointRange (&ranges)[N], uint32_t codePoint) {
+    const CodePointRange* end = ranges + N;
+    const CodePointRange* it = std::upper_bound(ranges, end, codePoint,
+        [](uint32_t value, const CodePointRange& range) { return value < range.first; });
+    return it != ranges && codePoint <= (it - 1)->last;
+}
+
+bool isUnicodeIdentifierContinue(uint32_t codePoint) {
+    return inRanges(identifierRanges, codePoint);
+}
+
+bool isUnicodeIdentifierStart(uint32_t codePoint) {
+    return inRanges(identifierRanges, codePoint) && !inRanges(combiningRanges, codePoint);
+}
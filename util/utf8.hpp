@@ -0,0 +1,27 @@
+#ifndef UTF8_HPP
+#define UTF8_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Offset of the first byte that does not start a well-formed UTF-8 sequence
+// (overlong forms, surrogates and code points above U+10FFFF are rejected),
+// or size if the whole buffer is valid. ASCII runs are skipped 16 bytes at a
+// time with SSE2 where available.
+size_t findInvalidUtf8(const char* data, size_t size);
+
+// true if every byte is below 0x80
+bool isAscii(const char* data, size_t size);
+
+// Decodes the sequence at data (already validated); returns its length in bytes.
+size_t decodeUtf8(const char* data, size_t size, uint32_t& codePoint);
+
+// Identifier characters outside ASCII, C11 Annex D ranges.
+bool isUnicodeIdentifierStart(uint32_t codePoint);
+bool isUnicodeIdentifierContinue(uint32_t codePoint);
+
+inline bool isUtf8Continuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+#endif